@@ -0,0 +1,346 @@
+// CombiDaemon.cpp: определяет точку входа для консольного приложения.
+// Долгоживущий процесс с решателями Combi18, Combi23 и Combi51 (см. Common/Solvers.h): граф присылают
+// через локальный сокет (Unix domain socket), и на запрос не тратится ни запуск процесса, ни чтение файла.
+// Запуск: CombiDaemon путь_сокета [--threads=N] [--cache[=M]] [--cache-dir=каталог] -- N потоков пула
+// (по умолчанию по числу ядер, не больше MAX_THREADS), кэш ответов на M графов в памяти и, если задан
+// каталог, на диске (см. Common/ResultCache.h): повторно присланный граф не решается. Сокет прошлого
+// запуска по тому же пути заменяется; если там другой файл, демон не запускается.
+// --tour-max-vertices=K (по умолчанию TOUR_MAX_VERTICES) -- запрос tour с графом больше K вершин получает
+// ошибку: перебор экспоненциален, и один такой запрос занял бы поток пула неограниченно долго. Клиент может
+// только уменьшить предел своей опцией --max-vertices=...
+// Запрос: 4 байта длины (младший байт первым) и столько же байт текста; длиннее --max-request=N[K|M|G]
+// (по умолчанию MAX_REQUEST) -- соединение закрывается. Память под запрос выделяется по мере прихода байт.
+// Первая строка текста -- алгоритм:
+// "tour", "planarity" или "matching" (у matching можно дописать --engine=..., --init=..., --order=mindeg
+// и --relabel=..., у planarity -- --relabel=...),
+// остальное -- граф в текстовом формате соответствующей программы. Запрос "stats" -- счетчики кэша и память.
+// --mem-limit=N[K|M|G] -- предел памяти (см. Common/MemStats.h): запрос, которому ее не хватило, получает
+// ошибку, память решателей потока освобождается, демон работает дальше
+// Ответ: 4 байта длины и строка "ok " + ответ (как в пакетном режиме) или "error " + причина.
+// В одно соединение можно слать сколько угодно запросов подряд. Соединение обслуживает один поток пула,
+// пока клиент его не закроет или не замолчит на --idle-timeout=S секунд (по умолчанию IDLE_TIMEOUT): тогда
+// соединение закрывается, и простаивающие клиенты не держат потоки пула; разные соединения обслуживаются
+// параллельно
+
+#include "stdafx.h"
+#include "../Common/GraphIo.h"
+#include "../Common/Log.h"
+#include "../Common/MemStats.h"
+#include "../Common/Solvers.h"
+
+#ifdef _WIN32
+typedef SOCKET Socket;
+static const Socket NO_SOCKET = INVALID_SOCKET;
+inline void CloseSocket(Socket s) { closesocket(s); }
+#else
+typedef int Socket;
+static const Socket NO_SOCKET = -1;
+inline void CloseSocket(Socket s) { close(s); }
+#endif
+
+static const size_t MAX_REQUEST = 64 << 20;		// по умолчанию запрос длиннее -- ошибка клиента, соединение закрывается
+static const size_t REQUEST_CHUNK = 1 << 20;	// буфер запроса растет по мере прихода данных, не по заявленной длине
+static const size_t KEEP_BUFFER = 1 << 20;		// буфер больше после запроса освобождается
+static const size_t IDLE_TIMEOUT = 30;			// секунд без данных от клиента -- соединение закрывается
+static const size_t MAX_THREADS = 256;			// --threads больше -- урезается до этого
+// Замер Combi18 (выпускная сборка) на полных графах со случайными стоимостями: 12 вершин -- до 1,2 с,
+// 13 -- до 18 с, 14 и больше -- от 8 с до нескольких минут. Разреженные графы перебираются быстрее
+static const size_t TOUR_MAX_VERTICES = 12;
+
+struct DaemonConfig				// настройки из командной строки, общие для потоков пула
+{
+	ResultCache* cache = nullptr;
+	size_t tourMaxVertices = TOUR_MAX_VERTICES;
+	size_t maxRequest = MAX_REQUEST;
+	size_t idleSeconds = IDLE_TIMEOUT;
+};
+
+struct SolverScratch				// рабочее состояние потока пула: память решателей и буферы запроса
+{
+	std::shared_ptr<void> tour;
+	std::shared_ptr<void> planarity;
+	std::shared_ptr<void> matching;
+	std::vector<std::string> options;
+	std::string request;
+	std::string answer;
+	std::string reply;				// 4 байта длины и ответ -- отправляется одним вызовом send
+};
+
+struct ConnectionQueue				// принятые соединения, ждущие свободного потока пула
+{
+	std::mutex lock;
+	std::condition_variable ready;
+	std::deque<Socket> waiting;
+
+	void Push(Socket s)
+	{
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			waiting.push_back(s);
+		}
+		ready.notify_one();
+	}
+
+	Socket Pop()
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		ready.wait(guard, [this]() { return !waiting.empty(); });
+		Socket s = waiting.front();
+		waiting.pop_front();
+		return s;
+	}
+};
+
+bool RecvAll(Socket s, char* buf, size_t size)
+{
+	while (size > 0)
+	{
+		int got = recv(s, buf, (int)std::min<size_t>(size, 1 << 20), 0);
+		if (got <= 0) return false;
+		buf += got;
+		size -= got;
+	}
+	return true;
+}
+
+bool SendAll(Socket s, char const* buf, size_t size)
+{
+	while (size > 0)
+	{
+		int sent = send(s, buf, (int)std::min<size_t>(size, 1 << 20), 0);
+		if (sent <= 0) return false;
+		buf += sent;
+		size -= sent;
+	}
+	return true;
+}
+
+bool ReceiveRequest(Socket s, size_t length, std::string& request)
+{	// клиент, приславший только длину, не заставляет выделять всю ее сразу
+	request.clear();
+	while (request.size() < length)
+	{
+		size_t have = request.size();
+		size_t chunk = std::min(length - have, REQUEST_CHUNK);
+		request.resize(have + chunk);
+		if (!RecvAll(s, &request[have], chunk)) return false;
+	}
+	return true;
+}
+
+void ReleaseLarge(std::string& buffer)
+{
+	if (buffer.capacity() > KEEP_BUFFER) std::string().swap(buffer);
+}
+
+bool Answer(SolverScratch& scratch, DaemonConfig const& config)
+{	// первая строка запроса -- алгоритм и опции, остальное -- граф
+	ResultCache* cache = config.cache;
+	std::string const& request = scratch.request;
+	size_t lineEnd = std::min(request.find('\n'), request.size());
+	std::istringstream header(request.substr(0, lineEnd));
+	std::string algorithm;
+	std::string option;
+	header >> algorithm;
+	scratch.options.clear();
+	while (header >> option) scratch.options.push_back(option);
+
+	GraphSource source;
+	source.Attach(request.data() + std::min(lineEnd + 1, request.size()), request.data() + request.size());
+	if (algorithm == "tour")
+	{
+		scratch.options.push_back("--max-vertices=" + std::to_string(config.tourMaxVertices));
+		return Tour::Solve(source, scratch.options, cache, scratch.tour, scratch.answer);
+	}
+	if (algorithm == "planarity") return Planarity::Solve(source, scratch.options, cache, scratch.planarity, scratch.answer);
+	if (algorithm == "matching") return Matching::Solve(source, scratch.options, cache, scratch.matching, scratch.answer);
+	if (algorithm == "stats")
+	{
+		scratch.answer = (cache ? "cache " + CacheStats(*cache) : "cache off") + ", memory: " + MemorySummary();
+		return true;
+	}
+	scratch.answer = "unknown algorithm " + algorithm;
+	return false;
+}
+
+bool SetReceiveTimeout(Socket s, size_t seconds)	// recv, не дождавшийся данных, вернет ошибку
+{
+#ifdef _WIN32
+	DWORD timeout = (DWORD)std::min<size_t>(seconds * 1000, MAXDWORD);
+#else
+	timeval timeout = {};
+	timeout.tv_sec = (time_t)seconds;
+#endif
+	return setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, (char const*)&timeout, sizeof(timeout)) == 0;
+}
+
+void ServeConnection(Socket s, SolverScratch& scratch, DaemonConfig const& config)
+{
+	if (!SetReceiveTimeout(s, config.idleSeconds))
+	{
+		CloseSocket(s);
+		return;
+	}
+	unsigned char prefix[4];
+	while (RecvAll(s, (char*)prefix, sizeof(prefix)))
+	{
+		uint32_t length = prefix[0] | (prefix[1] << 8) | (prefix[2] << 16) | ((uint32_t)prefix[3] << 24);
+		if (length > config.maxRequest) break;
+		bool received = false;
+		try
+		{
+			received = ReceiveRequest(s, length, scratch.request);
+		}
+		catch (std::bad_alloc const&)
+		{	// запрос не уместился в --mem-limit: его не дочитать, соединение закрывается
+		}
+		if (!received) break;
+
+		bool solved = false;
+		try
+		{
+			solved = Answer(scratch, config);
+		}
+		catch (std::bad_alloc const&)
+		{	// граф не уместился в --mem-limit: память решателей потока -- заново
+			scratch.tour.reset();
+			scratch.planarity.reset();
+			scratch.matching.reset();
+			scratch.answer = MemoryExhaustedMessage();
+		}
+		uint32_t replyLength = (uint32_t)scratch.answer.size() + (solved ? 3 : 6);
+		scratch.reply.clear();
+		for (int i = 0; i < 4; ++i) scratch.reply.push_back((char)(replyLength >> (8 * i)));
+		scratch.reply += solved ? "ok " : "error ";
+		scratch.reply += scratch.answer;
+		bool sent = SendAll(s, scratch.reply.data(), scratch.reply.size());
+		ReleaseLarge(scratch.request);
+		ReleaseLarge(scratch.answer);
+		ReleaseLarge(scratch.reply);
+		if (!sent) break;
+	}
+	ReleaseLarge(scratch.request);
+	CloseSocket(s);
+}
+
+bool RemoveStaleSocket(std::string const& path)
+{	// сокет, оставшийся от прошлого запуска, удаляется; любой другой файл по этому пути -- нет (false)
+#ifdef _WIN32
+	DWORD attr = GetFileAttributesA(path.c_str());
+	if (attr == INVALID_FILE_ATTRIBUTES) return true;
+	if (!(attr & FILE_ATTRIBUTE_REPARSE_POINT)) return false;	// сокет AF_UNIX в Windows -- точка повторной обработки
+#else
+	struct stat st;
+	if (lstat(path.c_str(), &st) != 0) return true;
+	if (!S_ISSOCK(st.st_mode)) return false;
+#endif
+	std::remove(path.c_str());
+	return true;
+}
+
+void PoolWorker(ConnectionQueue& queue, DaemonConfig const& config)
+{
+	SolverScratch scratch;
+	while (true) ServeConnection(queue.Pop(), scratch, config);
+}
+
+MEM_STATS_HOOKS()
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		Out() << "Socket path expected!" << std::endl;
+		return 1;
+	}
+	std::string socketPath(argv[1]);
+	size_t threads = 0;
+	DaemonConfig config;
+	size_t cacheEntries = 0;
+	std::string cacheDir;
+	for (int i = 2; i < argc; ++i)
+	{
+		std::string arg(argv[i]);
+		if (ParseCountOption(arg, "--threads=", threads)) {}
+		else if (ParseCountOption(arg, "--tour-max-vertices=", config.tourMaxVertices)) {}
+		else if (ParseCountOption(arg, "--idle-timeout=", config.idleSeconds)) {}
+		else if (arg.compare(0, 14, "--max-request=") == 0)
+		{
+			size_t bytes = 0;
+			if (ParseByteSize(arg.c_str() + 14, bytes) && (bytes > 0)) config.maxRequest = bytes;
+			else Out() << "Bad value in " << arg << ": size N[K|M|G] expected, option ignored\n";
+		}
+		else if (ParseCacheOption(arg, cacheEntries, cacheDir)) {}
+		else if (ParseMemoryOption(arg)) {}
+		else Out() << "Unknown option " << arg << " ignored\n";
+	}
+	if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+	threads = std::min(threads, MAX_THREADS);
+
+#ifdef _WIN32
+	WSADATA wsaData;
+	if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+	{
+		Out() << "Cannot start Winsock" << std::endl;
+		return 1;
+	}
+#else
+	signal(SIGPIPE, SIG_IGN);	// клиент ушел, не дождавшись ответа, -- закрываем соединение, а не процесс
+#endif
+
+	sockaddr_un addr = {};
+	addr.sun_family = AF_UNIX;
+	if (socketPath.size() >= sizeof(addr.sun_path))
+	{
+		Out() << "Socket path " << socketPath << " is too long" << std::endl;
+		return 1;
+	}
+	std::copy(socketPath.begin(), socketPath.end(), addr.sun_path);
+	if (!RemoveStaleSocket(socketPath))
+	{
+		Out() << socketPath << " exists and is not a socket, not replacing it" << std::endl;
+		return 1;
+	}
+
+	Socket listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if ((listener == NO_SOCKET) || (bind(listener, (sockaddr*)&addr, sizeof(addr)) != 0)
+		|| (listen(listener, SOMAXCONN) != 0))
+	{
+		Out() << "Cannot listen on " << socketPath << std::endl;
+		return 1;
+	}
+	Out() << "Listening on " << socketPath << " with " << threads << " threads" << std::endl;
+
+	ResultCache cache;
+	if (cacheEntries > 0)
+	{
+		if (!cache.Open(cacheEntries, cacheDir))
+		{
+			Out() << "Cannot open cache " << cacheDir << std::endl;
+			return 1;
+		}
+		config.cache = &cache;
+	}
+
+	ConnectionQueue queue;
+	std::vector<std::thread> pool;
+	try
+	{
+		pool.reserve(threads);
+		for (size_t t = 0; t < threads; ++t) pool.emplace_back(PoolWorker, std::ref(queue), std::cref(config));
+	}
+	catch (std::exception const&)
+	{	// без учета памяти --mem-limit ограничивает и стеки потоков (см. MemStats.h): работаем на тех, что есть
+		if (pool.empty())
+		{
+			Out() << "Cannot start pool threads" << std::endl;
+			return 1;
+		}
+		Out() << "Started " << pool.size() << " of " << threads << " threads" << std::endl;
+	}
+	while (true)
+	{
+		Socket client = accept(listener, nullptr, nullptr);
+		if (client != NO_SOCKET) queue.Push(client);
+	}
+}
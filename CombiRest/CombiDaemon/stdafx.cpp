@@ -0,0 +1,8 @@
+// stdafx.cpp: исходный файл, содержащий только стандартные включаемые модули
+// CombiDaemon.pch будет использоваться в качестве предкомпилированного заголовка
+// stdafx.obj будет содержать предварительно откомпилированные сведения о типе
+
+#include "stdafx.h"
+
+// TODO: Установите ссылки на любые требующиеся дополнительные заголовки в файле STDAFX.H
+// , а не в данном файле
@@ -0,0 +1,165 @@
+// Batch.h: пакетный режим Combi18, Combi23 и Combi51, только заголовок.
+// Вход пакета -- каталог (все его файлы по алфавиту), список файлов (путь в каждой строке; относительные
+// пути -- от каталога списка) или один файл, в котором графы записаны подряд.
+// Экземпляры решаются на фиксированном пуле потоков. У каждого потока свое рабочее состояние Scratch,
+// оно переиспользуется от экземпляра к экземпляру. Ответ -- одна строка на экземпляр, в порядке входа;
+// экземпляру, которому не хватило памяти, -- "memory limit exceeded", остальные решаются дальше
+
+#pragma once
+
+#include "GraphIo.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <new>
+#include <thread>
+#include <cctype>
+
+#ifndef _WIN32
+#include <dirent.h>
+#endif
+
+struct BatchInstance
+{
+	std::string name;				// путь к файлу или "#k" для k-го графа общего файла
+	GraphSource source;				// для общего файла -- уже отображенный текст экземпляра
+};
+
+inline bool IsDirectory(std::string const& path)
+{
+#ifdef _WIN32
+	DWORD attr = GetFileAttributesA(path.c_str());
+	return (attr != INVALID_FILE_ATTRIBUTES) && (attr & FILE_ATTRIBUTE_DIRECTORY);
+#else
+	struct stat st;
+	return (stat(path.c_str(), &st) == 0) && S_ISDIR(st.st_mode);
+#endif
+}
+
+inline bool ListDirectory(std::string const& dir, std::vector<std::string>& files)
+{
+#ifdef _WIN32
+	WIN32_FIND_DATAA found;
+	HANDLE h = FindFirstFileA((dir + "\\*").c_str(), &found);
+	if (h == INVALID_HANDLE_VALUE) return false;
+	do
+	{
+		if (!(found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) files.push_back(dir + "\\" + found.cFileName);
+	} while (FindNextFileA(h, &found));
+	FindClose(h);
+#else
+	DIR* d = opendir(dir.c_str());
+	if (!d) return false;
+	while (dirent* entry = readdir(d))
+	{
+		std::string path = dir + "/" + entry->d_name;
+		if ((entry->d_name[0] != '.') && !IsDirectory(path)) files.push_back(path);
+	}
+	closedir(d);
+#endif
+	std::sort(files.begin(), files.end());
+	return true;
+}
+
+inline bool CollectBatchFiles(std::string const& input, std::vector<BatchInstance>& instances)
+{	// каталог или список файлов
+	std::vector<std::string> files;
+	if (IsDirectory(input))
+	{
+		if (!ListDirectory(input, files)) return false;
+	}
+	else
+	{
+		MappedFile manifest;
+		if (!manifest.Open(input)) return false;
+		std::string dir;
+		size_t slash = input.find_last_of("/\\");
+		if (slash != std::string::npos) dir = input.substr(0, slash + 1);
+
+		TextScanner lines(manifest.data, manifest.data + manifest.size);
+		char const* lineBegin = nullptr;
+		char const* lineEnd = nullptr;
+		while (lines.NextLine(lineBegin, lineEnd))
+		{
+			while ((lineBegin < lineEnd) && ((*lineBegin == ' ') || (*lineBegin == '\t'))) ++lineBegin;
+			while ((lineEnd > lineBegin) && ((lineEnd[-1] == ' ') || (lineEnd[-1] == '\t'))) --lineEnd;
+			if ((lineBegin == lineEnd) || (*lineBegin == '#')) continue;
+			std::string path(lineBegin, lineEnd);
+			bool absolute = (path[0] == '/') || (path[0] == '\\') || ((path.size() > 1) && (path[1] == ':'));
+			files.push_back(absolute ? path : dir + path);
+		}
+	}
+	for (auto& file : files)
+	{
+		BatchInstance instance;
+		instance.name = file;
+		instances.push_back(instance);
+	}
+	return true;
+}
+
+template <typename SkipOne>
+bool SplitConcatenated(std::string const& input, SkipOne skipOne, std::vector<BatchInstance>& instances)
+{	// skipOne(scanner) проходит ровно один граф и возвращает false, если граф оборван
+	GraphSource whole;
+	if (!whole.Open(input)) return false;
+	TextScanner scanner = whole.Text();
+	while (true)
+	{
+		while ((scanner.cur < scanner.end) && std::isspace((unsigned char)*scanner.cur)) ++scanner.cur;
+		if (scanner.cur == scanner.end) break;
+		BatchInstance instance;
+		instance.name = "#" + std::to_string(instances.size() + 1);
+		instance.source.file = whole.file;
+		instance.source.begin = scanner.cur;
+		if (!skipOne(scanner)) return false;
+		instance.source.end = scanner.cur;
+		instances.push_back(instance);
+	}
+	return true;
+}
+
+template <typename Scratch, typename Solve>
+void RunBatch(std::vector<BatchInstance> const& instances, size_t threads, Solve solve)
+{	// solve(экземпляр, рабочее состояние потока, строка ответа). Потоки разбирают экземпляры по одному
+	// через общий счетчик; ответы копятся и печатаются в порядке входа
+	std::vector<std::string> lines(instances.size());
+	std::atomic<size_t> next(0);
+	auto worker = [&]()
+	{
+		Scratch scratch;
+		for (size_t i = next++; i < instances.size(); i = next++)
+		{
+			try
+			{
+				solve(instances[i], scratch, lines[i]);
+			}
+			catch (std::bad_alloc const&)
+			{	// экземпляр не уместился в --mem-limit (см. MemStats.h): ответ о том, память потока -- заново
+				scratch = Scratch();
+				lines[i] = instances[i].name + ": memory limit exceeded";
+			}
+		}
+	};
+
+	if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+	threads = std::max<size_t>(1, std::min(threads, instances.size()));
+	std::vector<std::thread> pool;
+	try
+	{
+		pool.reserve(threads - 1);
+		for (size_t t = 1; t < threads; ++t) pool.emplace_back(worker);
+	}
+	catch (std::exception const&)
+	{	// поток не запустился (без учета памяти --mem-limit ограничивает и стеки потоков, см. MemStats.h):
+		// экземпляры разберут уже запущенные
+		Out() << "Started " << pool.size() + 1 << " of " << threads << " threads\n";
+	}
+	worker();
+	for (auto& th : pool) th.join();
+
+	for (auto& line : lines) Out() << line << "\n";
+	Out().flush();
+}
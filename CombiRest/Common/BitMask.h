@@ -0,0 +1,77 @@
+// BitMask.h: множества вершин малого графа в одном машинном слове, только заголовок.
+// Бит i -- вершина i. Решатели заводят для графов до 64 вершин отдельные ядра, шаблонные по типу слова
+// Mask (uint32_t или uint64_t): смежность, степени, пометки -- слова, а не массивы, и перебор не выделяет
+// память. WithSmallMask выбирает самое узкое слово по наибольшему номеру бита при загрузке графа:
+// в 32-битной сборке uint64_t -- два регистра, поэтому графам до 32 вершин -- uint32_t
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+inline int Ctz(uint32_t x)	// номер младшего единичного бита, x != 0
+{
+#if defined(_MSC_VER)
+	unsigned long idx;
+	_BitScanForward(&idx, x);
+	return idx;
+#else
+	return __builtin_ctz(x);
+#endif
+}
+
+inline int Ctz(uint64_t x)	// номер младшего единичного бита, x != 0
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long idx;
+	_BitScanForward64(&idx, x);
+	return idx;
+#elif defined(_MSC_VER)
+	unsigned long idx;
+	if (_BitScanForward(&idx, (unsigned long)x)) return idx;
+	_BitScanForward(&idx, (unsigned long)(x >> 32));
+	return idx + 32;
+#else
+	return __builtin_ctzll(x);
+#endif
+}
+
+template <typename Mask>
+inline Mask Bit(size_t i)
+{
+	return Mask(1) << i;
+}
+
+template <typename Mask>
+inline Mask LowBits(size_t n)	// биты 0..n-1
+{
+	return (n >= sizeof(Mask) * 8) ? ~Mask(0) : (Mask(1) << n) - 1;
+}
+
+template <typename Mask>
+inline int PopFirst(Mask& set)	// номер младшего бита, бит снимается; set != 0
+{
+	int i = Ctz(set);
+	set &= set - 1;
+	return i;
+}
+
+template <typename Kernel>
+bool WithSmallMask(size_t maxBit, Kernel&& kernel)
+{	// kernel(Mask()) с самым узким словом, вмещающим биты 0..maxBit; false -- не вмещает ни одно
+	if (maxBit < 32)
+	{
+		kernel(uint32_t());
+		return true;
+	}
+	if (maxBit < 64)
+	{
+		kernel(uint64_t());
+		return true;
+	}
+	return false;
+}
@@ -0,0 +1,190 @@
+// CsrGraph.h: общий для Combi18, Combi23 и Combi51 граф в формате CSR (compressed sparse row), только заголовок.
+// Соседи вершины v лежат подряд: adj[start[v]] .. adj[start[v + 1] - 1]. Вершины нумеруются с 1.
+// V -- тип номера вершины (uint16_t, uint32_t), W -- тип стоимости ребра (NoWeight для невзвешенного графа).
+// Массивы читаются через ArrayView: они лежат либо в собственных векторах графа, либо прямо
+// в отображенном в память двоичном файле (см. GraphIo.h)
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <utility>
+#include <type_traits>
+#include <memory>
+
+struct NoWeight {};
+
+template <typename V>
+struct NeighSpan					// соседи одной вершины -- для range-for и алгоритмов std
+{
+	V const* first;
+	V const* last;
+
+	V const* begin() const { return first; }
+	V const* end() const { return last; }
+	size_t size() const { return last - first; }
+	bool empty() const { return first == last; }
+	V operator[](size_t i) const { return first[i]; }
+};
+
+template <typename T>
+struct ArrayView					// массив только для чтения: данные вектора-владельца или отображенного файла
+{
+	T const* ptr = nullptr;
+	size_t count = 0;
+
+	T const& operator[](size_t i) const { return ptr[i]; }
+	T const* data() const { return ptr; }
+	T const* begin() const { return ptr; }
+	T const* end() const { return ptr + count; }
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+};
+
+template <typename T>
+ArrayView<T> ViewOf(std::vector<T> const& vec)
+{
+	ArrayView<T> view;
+	view.ptr = vec.data();
+	view.count = vec.size();
+	return view;
+}
+
+template <typename V = uint32_t, typename W = NoWeight>
+struct CsrGraph
+{
+	typedef V Vertex;
+	typedef W Weight;
+	static const bool weighted = !std::is_same<W, NoWeight>::value;
+
+	size_t numVert = 0;
+	ArrayView<size_t> start;		// numVert + 2 чисел, start[0] и start[1] -- нули
+	ArrayView<V> adj;				// соседи всех вершин подряд
+	ArrayView<W> weight;			// стоимости в том же порядке, что adj (пусто для NoWeight)
+
+	std::vector<size_t> startBuf;	// владельцы массивов, если граф построен в памяти
+	std::vector<V> adjBuf;
+	std::vector<W> weightBuf;
+	std::shared_ptr<void> mapping;	// отображенный файл, если массивы смотрят в него
+
+	CsrGraph() = default;
+	CsrGraph(CsrGraph&&) = default;
+	CsrGraph& operator=(CsrGraph&&) = default;
+	CsrGraph(CsrGraph const& other) { *this = other; }
+	CsrGraph& operator=(CsrGraph const& other)
+	{	// при копировании построенного в памяти графа представления должны смотреть в свои векторы
+		if (this == &other) return *this;
+		numVert = other.numVert;
+		startBuf = other.startBuf;
+		adjBuf = other.adjBuf;
+		weightBuf = other.weightBuf;
+		mapping = other.mapping;
+		start = (other.start.ptr == other.startBuf.data()) ? ViewOf(startBuf) : other.start;
+		adj = (other.adj.ptr == other.adjBuf.data()) ? ViewOf(adjBuf) : other.adj;
+		weight = (other.weight.ptr == other.weightBuf.data()) ? ViewOf(weightBuf) : other.weight;
+		return *this;
+	}
+
+	void Attach()					// массивы построены в векторах: переключаем представления на них
+	{
+		start = ViewOf(startBuf);
+		adj = ViewOf(adjBuf);
+		weight = ViewOf(weightBuf);
+		mapping.reset();
+	}
+
+	size_t Degree(size_t v) const { return start[v + 1] - start[v]; }
+	V Neighbour(size_t v, size_t i) const { return adj[start[v] + i]; }
+	W const& EdgeWeight(size_t v, size_t i) const { return weight[start[v] + i]; }
+	NeighSpan<V> Neighbours(size_t v) const { return { adj.data() + start[v], adj.data() + start[v + 1] }; }
+	size_t NumArcs() const { return adj.size(); }
+};
+
+template <typename V, typename W>
+void BuildCsr(CsrGraph<V, W>& graph, size_t numVert, std::vector<std::pair<V, V>> const& edges,
+	std::vector<W> const& weights, bool undirected)
+{	// один проход сортировки подсчетом. Порядок соседей -- порядок ребер во входном списке;
+	// в неориентированном графе ребро u -- v попадает и к u, и к v. weights пуст или той же длины, что edges
+	std::vector<size_t>& start = graph.startBuf;
+	graph.numVert = numVert;
+	start.assign(numVert + 2, 0);
+	for (auto& edge : edges)
+	{
+		start[edge.first + 1]++;
+		if (undirected) start[edge.second + 1]++;
+	}
+	for (size_t v = 1; v <= numVert + 1; ++v) start[v] += start[v - 1];
+
+	graph.adjBuf.resize(start[numVert + 1]);
+	graph.weightBuf.resize(weights.empty() ? 0 : graph.adjBuf.size());
+	std::vector<size_t> pos(start.begin(), start.end() - 1);
+	for (size_t i = 0; i < edges.size(); ++i)
+	{
+		V from = edges[i].first;
+		V to = edges[i].second;
+		size_t at = pos[from]++;
+		graph.adjBuf[at] = to;
+		if (!weights.empty()) graph.weightBuf[at] = weights[i];
+		if (undirected)
+		{
+			at = pos[to]++;
+			graph.adjBuf[at] = from;
+			if (!weights.empty()) graph.weightBuf[at] = weights[i];
+		}
+	}
+	graph.Attach();
+}
+
+template <typename V>
+void BuildCsr(CsrGraph<V, NoWeight>& graph, size_t numVert, std::vector<std::pair<V, V>> const& edges, bool undirected)
+{
+	BuildCsr(graph, numVert, edges, std::vector<NoWeight>(), undirected);
+}
+
+template <typename V, typename W>
+void BuildTransposed(CsrGraph<V, W> const& graph, size_t numVertTo, CsrGraph<V, W>& rev)
+{	// обратные дуги ориентированного графа (например, смежность второй доли двудольного графа)
+	std::vector<size_t>& start = rev.startBuf;
+	rev.numVert = numVertTo;
+	start.assign(numVertTo + 2, 0);
+	for (auto& to : graph.adj) start[to + 1]++;
+	for (size_t v = 1; v <= numVertTo + 1; ++v) start[v] += start[v - 1];
+
+	rev.adjBuf.resize(graph.adj.size());
+	rev.weightBuf.resize(graph.weight.size());
+	std::vector<size_t> pos(start.begin(), start.end() - 1);
+	for (size_t v = 1; v <= graph.numVert; ++v)
+	{
+		for (size_t k = graph.start[v]; k < graph.start[v + 1]; ++k)
+		{
+			size_t at = pos[graph.adj[k]]++;
+			rev.adjBuf[at] = (V)v;
+			if (!graph.weight.empty()) rev.weightBuf[at] = graph.weight[k];
+		}
+	}
+	rev.Attach();
+}
+
+template <typename V, typename W>
+void PermuteCsr(CsrGraph<V, W> const& graph, std::vector<V> const& order, std::vector<V> const& newNumber, CsrGraph<V, W>& out)
+{	// вершина i графа out -- вершина order[i] графа graph, сосед u -- newNumber[u]; порядок соседей и стоимости
+	// сохраняются. У неориентированного графа newNumber -- обратная к order перестановка, у двудольного -- своя
+	size_t numVert = order.size() - 1;
+	std::vector<size_t>& start = out.startBuf;
+	out.numVert = numVert;
+	start.assign(numVert + 2, 0);
+	out.adjBuf.resize(graph.adj.size());
+	out.weightBuf.resize(graph.weight.size());
+	for (size_t i = 1; i <= numVert; ++i)
+	{
+		size_t at = start[i];
+		for (size_t k = graph.start[order[i]]; k < graph.start[order[i] + 1]; ++k, ++at)
+		{
+			out.adjBuf[at] = newNumber[graph.adj[k]];
+			if (!graph.weight.empty()) out.weightBuf[at] = graph.weight[k];
+		}
+		start[i + 1] = at;
+	}
+	out.Attach();
+}
@@ -0,0 +1,454 @@
+// GraphIo.h: быстрый ввод графов для Combi18, Combi23 и Combi51, только заголовок.
+// Текстовый файл отображается в память и разбирается вручную (без iostream и stringstream).
+// Двоичный формат -- заголовок BinGraphHeader и массивы CSR; при загрузке массивы CsrGraph смотрят
+// прямо в отображенный файл, ничего не копируется.
+// Разделы файла идут после заголовка, каждый с границы 8 байт:
+//   start   -- numVert + 2 чисел uint64_t
+//   adj     -- numArcs номеров вершин по vertBytes байт
+//   weight  -- numArcs стоимостей по weightBytes байт (если weightBytes > 0)
+//   edges   -- numEdges пар номеров вершин в порядке исходного файла (если есть флаг BinEdgeList)
+//   edgeW   -- numEdges стоимостей этих ребер (если есть BinEdgeList и weightBytes > 0)
+// Файлу при загрузке не доверяем: размеры разделов проверяются на переполнение и на длину файла, start -- на
+// монотонность, номера вершин в adj и в списке ребер -- на диапазон 1..numVert (у двудольного графа, без
+// BinUndirected, соседи -- 1..numVert2). Это один проход по массивам, без копирования
+
+#pragma once
+
+#include "CsrGraph.h"
+
+#include <string>
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+#include <limits>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+struct MappedFile					// файл, целиком отображенный в память только для чтения
+{
+	char const* data = nullptr;
+	size_t size = 0;
+#ifdef _WIN32
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE section = nullptr;
+#else
+	int fd = -1;
+#endif
+
+	MappedFile() = default;
+	MappedFile(MappedFile const&) = delete;
+	MappedFile& operator=(MappedFile const&) = delete;
+	~MappedFile() { Close(); }
+
+	bool Open(std::string const& fileName)
+	{
+		Close();
+#ifdef _WIN32
+		file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+			FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return false;
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize)) return false;
+		size = (size_t)fileSize.QuadPart;
+		if (size == 0)
+		{
+			data = "";
+			return true;
+		}
+		section = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (section == nullptr) return false;
+		data = static_cast<char const*>(MapViewOfFile(section, FILE_MAP_READ, 0, 0, 0));
+		return data != nullptr;
+#else
+		fd = open(fileName.c_str(), O_RDONLY);
+		if (fd < 0) return false;
+		struct stat st;
+		if (fstat(fd, &st) != 0) return false;
+		size = (size_t)st.st_size;
+		if (size == 0)
+		{
+			data = "";
+			return true;
+		}
+		void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (addr == MAP_FAILED) return false;
+		madvise(addr, size, MADV_SEQUENTIAL);
+		data = static_cast<char const*>(addr);
+		return true;
+#endif
+	}
+
+	void Close()
+	{
+#ifdef _WIN32
+		if (data && size) UnmapViewOfFile(data);
+		if (section) CloseHandle(section);
+		if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+		section = nullptr;
+		file = INVALID_HANDLE_VALUE;
+#else
+		if (data && size) munmap(const_cast<char*>(data), size);
+		if (fd >= 0) close(fd);
+		fd = -1;
+#endif
+		data = nullptr;
+		size = 0;
+	}
+};
+
+struct TextScanner					// разбор целых чисел в буфере [cur, end) без копирования
+{
+	char const* cur;
+	char const* end;
+
+	TextScanner(char const* b, char const* e) : cur(b), end(e) {}
+
+	bool NextInt(long long& value)	// пропускает пробелы и переводы строк; false -- конец или не число
+	{
+		while ((cur < end) && ((*cur == ' ') || (*cur == '\t') || (*cur == '\n') || (*cur == '\r'))) ++cur;
+		if (cur == end) return false;
+		bool negative = (*cur == '-');
+		if ((*cur == '-') || (*cur == '+')) ++cur;
+		if ((cur == end) || (*cur < '0') || (*cur > '9')) return false;
+		unsigned long long x = 0;
+		while ((cur < end) && (*cur >= '0') && (*cur <= '9')) x = x * 10 + (*cur++ - '0');
+		value = negative ? -(long long)x : (long long)x;
+		return true;
+	}
+
+	template <typename T>
+	bool Next(T& value)
+	{
+		long long x = 0;
+		if (!NextInt(x)) return false;
+		value = (T)x;
+		return true;
+	}
+
+	bool Next(NoWeight&) { return true; }
+
+	bool NextLine(char const*& lineBegin, char const*& lineEnd) // строка без '\n' и '\r'; false -- конец буфера
+	{
+		if (cur == end) return false;
+		lineBegin = cur;
+		while ((cur < end) && (*cur != '\n')) ++cur;
+		lineEnd = cur;
+		if (cur < end) ++cur;
+		if ((lineEnd > lineBegin) && (lineEnd[-1] == '\r')) --lineEnd;
+		return true;
+	}
+};
+
+template <typename V>
+bool TextVertexCount(long long count)	// число вершин из текста: номера 1..count должны уместиться в V
+{
+	return (count >= 0) && ((unsigned long long)count < (unsigned long long)std::numeric_limits<V>::max());
+}
+
+inline size_t TextEdgeReserve(TextScanner const& in, long long declared)
+{	// сколько ребер резервировать: объявленному числу не верим дальше длины текста (на ребро -- не меньше 4 байт)
+	size_t fits = (size_t)(in.end - in.cur) / 4 + 1;
+	return (declared <= 0) ? 0 : std::min(fits, (size_t)declared);
+}
+
+template <typename V, typename W>
+bool ReadEdgeList(TextScanner& in, size_t& numVert, size_t& numEdges, std::vector<std::pair<V, V>>& edges,
+	std::vector<W>* weights)
+{	// формат Combi18 и Combi23: "число вершин число ребер", затем ребра "вершина вершина [стоимость]".
+	// Стоимость читается, если weights не nullptr. Ребра с концами вне 1..numVert пропускаются.
+	// numEdges -- число ребер, объявленное в первой строке. false -- число вершин отрицательно или не
+	// умещается в V (текст может прийти от клиента CombiDaemon, ему не доверяем)
+	long long declaredVert = 0;
+	long long declaredEdges = 0;
+	in.NextInt(declaredVert);
+	in.NextInt(declaredEdges);
+	edges.clear();
+	if (weights) weights->clear();
+	numVert = 0;
+	numEdges = (declaredEdges < 0) ? 0 : (size_t)declaredEdges;
+	if (!TextVertexCount<V>(declaredVert)) return false;
+	numVert = (size_t)declaredVert;
+	edges.reserve(TextEdgeReserve(in, declaredEdges));
+	for (size_t i = 0; i < numEdges; ++i)
+	{
+		long long vert1 = 0;
+		long long vert2 = 0;
+		W weight = W();
+		if (!in.NextInt(vert1) || !in.NextInt(vert2)) break;
+		if (weights && !in.Next(weight)) break;
+		if ((vert1 < 1) || (vert2 < 1) || ((size_t)vert1 > numVert) || ((size_t)vert2 > numVert)) continue;
+		edges.push_back(std::make_pair((V)vert1, (V)vert2));
+		if (weights) weights->push_back(weight);
+	}
+	return true;
+}
+
+static const char BIN_GRAPH_MAGIC[8] = { 'C', 'M', 'B', 'G', 'R', 'A', 'P', 'H' };
+static const uint32_t BIN_GRAPH_VERSION = 1;
+
+enum BinGraphFlags : uint32_t
+{
+	BinUndirected = 1,				// каждое ребро записано в CSR у обоих концов
+	BinEdgeList = 2					// после CSR сохранен исходный список ребер
+};
+
+struct BinGraphHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t vertBytes;				// размер номера вершины: 2 или 4
+	uint32_t weightBytes;			// 0 -- граф без стоимостей, иначе 4 или 8
+	uint32_t flags;
+	uint64_t numVert;				// вершин в CSR (для двудольного графа -- первая доля)
+	uint64_t numVert2;				// вторая доля двудольного графа, 0 для обычного
+	uint64_t numArcs;				// длина adj
+	uint64_t numEdges;				// длина списка ребер (если есть BinEdgeList)
+};
+
+inline size_t BinAlign(size_t offset) { return (offset + 7) & ~size_t(7); }
+
+inline bool BinSection(uint64_t count, uint64_t itemBytes, size_t fileSize, size_t& offset)
+{	// раздел из count элементов по itemBytes байт с offset; offset -- на следующий раздел.
+	// false -- размер переполняется или раздел не помещается в файл
+	if ((itemBytes > 0) && (count > (fileSize - offset) / itemBytes)) return false;
+	offset = std::min<size_t>(BinAlign(offset + (size_t)(count * itemBytes)), fileSize);
+	return true;
+}
+
+inline bool IsBinaryGraph(MappedFile const& file)
+{
+	return (file.size >= sizeof(BinGraphHeader)) && (std::memcmp(file.data, BIN_GRAPH_MAGIC, 8) == 0);
+}
+
+struct GraphSource					// граф в отображенном файле: весь файл или один граф из общего файла
+{
+	std::shared_ptr<MappedFile> file;
+	char const* begin = nullptr;
+	char const* end = nullptr;
+
+	bool Open(std::string const& fileName)
+	{
+		file = std::make_shared<MappedFile>();
+		if (!file->Open(fileName)) return false;
+		begin = file->data;
+		end = file->data + file->size;
+		return true;
+	}
+
+	void Attach(char const* textBegin, char const* textEnd)	// текст графа в чужом буфере (запрос демона)
+	{
+		file.reset();
+		begin = textBegin;
+		end = textEnd;
+	}
+
+	bool IsBinary() const { return file && (begin == file->data) && (end == file->data + file->size) && IsBinaryGraph(*file); }
+	TextScanner Text() const { return TextScanner(begin, end); }
+};
+
+inline uint64_t LoadPackedUnsigned(char const* p, uint32_t bytes)
+{
+	uint16_t x16;
+	uint32_t x32;
+	uint64_t x64;
+	if (bytes == 2) { std::memcpy(&x16, p, 2); return x16; }
+	if (bytes == 4) { std::memcpy(&x32, p, 4); return x32; }
+	std::memcpy(&x64, p, 8);
+	return x64;
+}
+
+inline long long LoadPackedSigned(char const* p, uint32_t bytes)
+{
+	int32_t x32;
+	int64_t x64;
+	if (bytes == 4) { std::memcpy(&x32, p, 4); return x32; }
+	std::memcpy(&x64, p, 8);
+	return x64;
+}
+
+template <typename W>
+void StoreWeight(W& dst, long long x) { dst = (W)x; }
+
+inline void StoreWeight(NoWeight&, long long) {}
+
+template <typename T>
+void SaveSection(std::ofstream& out, T const* data, size_t count)
+{
+	static const char zeros[8] = {};
+	out.write(reinterpret_cast<char const*>(data), count * sizeof(T));
+	size_t written = count * sizeof(T);
+	out.write(zeros, BinAlign(written) - written);
+}
+
+template <typename V, typename W>
+bool SaveBinaryGraph(std::string const& fileName, CsrGraph<V, W> const& graph, size_t numVert2, bool undirected,
+	std::vector<std::pair<V, V>> const* edges, std::vector<W> const* edgeWeights)
+{	// edges -- исходный список ребер (нужен Combi18 и Combi23: от порядка ребер зависит ход алгоритма)
+	std::ofstream out(fileName, std::ios::binary);
+	if (!out) return false;
+
+	bool weighted = CsrGraph<V, W>::weighted && !graph.weight.empty();
+	BinGraphHeader header;
+	std::memcpy(header.magic, BIN_GRAPH_MAGIC, 8);
+	header.version = BIN_GRAPH_VERSION;
+	header.vertBytes = sizeof(V);
+	header.weightBytes = weighted ? sizeof(W) : 0;
+	header.flags = 0;
+	if (undirected) header.flags |= BinUndirected;
+	if (edges) header.flags |= BinEdgeList;
+	header.numVert = graph.numVert;
+	header.numVert2 = numVert2;
+	header.numArcs = graph.adj.size();
+	header.numEdges = edges ? edges->size() : 0;
+	out.write(reinterpret_cast<char const*>(&header), sizeof(header));
+
+	std::vector<uint64_t> start(graph.start.begin(), graph.start.end());
+	SaveSection(out, start.data(), start.size());
+	SaveSection(out, graph.adj.data(), graph.adj.size());
+	if (weighted) SaveSection(out, graph.weight.data(), graph.weight.size());
+	if (edges)
+	{
+		std::vector<V> flat;
+		flat.reserve(2 * edges->size());
+		for (auto& edge : *edges)
+		{
+			flat.push_back(edge.first);
+			flat.push_back(edge.second);
+		}
+		SaveSection(out, flat.data(), flat.size());
+		if (weighted && edgeWeights) SaveSection(out, edgeWeights->data(), edgeWeights->size());
+	}
+	return static_cast<bool>(out);
+}
+
+template <typename V, typename W>
+bool LoadBinaryGraph(std::shared_ptr<MappedFile> const& file, CsrGraph<V, W>& graph, BinGraphHeader& header,
+	std::vector<std::pair<V, V>>* edges, std::vector<W>* edgeWeights)
+{	// массивы CSR не копируются, если размеры типов в файле совпадают с V, W и size_t; граф держит файл открытым.
+	// Список ребер (если он есть и нужен) копируется в edges и edgeWeights
+	if (!IsBinaryGraph(*file)) return false;
+	std::memcpy(&header, file->data, sizeof(header));
+	if ((header.version != BIN_GRAPH_VERSION) || ((header.vertBytes != 2) && (header.vertBytes != 4))) return false;
+	if ((header.weightBytes != 0) && (header.weightBytes != 4) && (header.weightBytes != 8)) return false;
+
+	size_t size = file->size;
+	size_t offStart = BinAlign(sizeof(header));
+	size_t offAdj = offStart;
+	if ((header.numVert > size) || !BinSection(header.numVert + 2, sizeof(uint64_t), size, offAdj)) return false;
+	size_t offWeight = offAdj;
+	if (!BinSection(header.numArcs, header.vertBytes, size, offWeight)) return false;
+	size_t offEdges = offWeight;
+	if (!BinSection(header.numArcs, header.weightBytes, size, offEdges)) return false;
+	size_t offEdgeW = offEdges;
+	if (header.flags & BinEdgeList)
+	{
+		if ((header.numEdges > size) || !BinSection(2 * header.numEdges, header.vertBytes, size, offEdgeW)) return false;
+		size_t end = offEdgeW;
+		if (!BinSection(header.numEdges, header.weightBytes, size, end)) return false;
+	}
+	uint64_t maxNeighbour = (header.flags & BinUndirected) ? header.numVert : header.numVert2;	// соседи -- 1..maxNeighbour
+	if (std::max<uint64_t>(header.numVert, maxNeighbour) > std::numeric_limits<V>::max()) return false;
+	char const* base = file->data;
+
+	graph.Attach();
+	graph.numVert = header.numVert;
+	graph.startBuf.clear();
+	graph.adjBuf.clear();
+	graph.weightBuf.clear();
+
+	if (sizeof(size_t) == sizeof(uint64_t))
+	{
+		graph.start.ptr = reinterpret_cast<size_t const*>(base + offStart);
+		graph.start.count = header.numVert + 2;
+	}
+	else
+	{
+		graph.startBuf.resize(header.numVert + 2);
+		for (size_t v = 0; v < graph.startBuf.size(); ++v)
+		{
+			graph.startBuf[v] = (size_t)LoadPackedUnsigned(base + offStart + v * sizeof(uint64_t), sizeof(uint64_t));
+		}
+		graph.start = ViewOf(graph.startBuf);
+	}
+	for (size_t v = 1; v <= header.numVert + 1; ++v)
+	{	// монотонность и start[numVert + 1] == numArcs: все окна соседей лежат в adj
+		if (graph.start[v] < graph.start[v - 1]) return false;
+	}
+	if (graph.start[header.numVert + 1] != header.numArcs) return false;
+
+	if (header.vertBytes == sizeof(V))
+	{
+		graph.adj.ptr = reinterpret_cast<V const*>(base + offAdj);
+		graph.adj.count = header.numArcs;
+	}
+	else
+	{
+		graph.adjBuf.resize(header.numArcs);
+		for (size_t k = 0; k < header.numArcs; ++k)
+		{
+			graph.adjBuf[k] = (V)LoadPackedUnsigned(base + offAdj + k * header.vertBytes, header.vertBytes);
+		}
+		graph.adj = ViewOf(graph.adjBuf);
+	}
+	for (size_t k = 0; k < header.numArcs; ++k)
+	{
+		if ((graph.adj[k] < 1) || (graph.adj[k] > maxNeighbour)) return false;
+	}
+
+	if (CsrGraph<V, W>::weighted && (header.weightBytes > 0))
+	{
+		if (header.weightBytes == sizeof(W))
+		{
+			graph.weight.ptr = reinterpret_cast<W const*>(base + offWeight);
+			graph.weight.count = header.numArcs;
+		}
+		else
+		{
+			graph.weightBuf.resize(header.numArcs);
+			for (size_t k = 0; k < header.numArcs; ++k)
+			{
+				StoreWeight(graph.weightBuf[k], LoadPackedSigned(base + offWeight + k * header.weightBytes, header.weightBytes));
+			}
+			graph.weight = ViewOf(graph.weightBuf);
+		}
+	}
+	graph.mapping = file;
+
+	if (edges && (header.flags & BinEdgeList))
+	{
+		edges->resize(header.numEdges);
+		for (size_t i = 0; i < header.numEdges; ++i)
+		{
+			char const* p = base + offEdges + 2 * i * header.vertBytes;
+			(*edges)[i].first = (V)LoadPackedUnsigned(p, header.vertBytes);
+			(*edges)[i].second = (V)LoadPackedUnsigned(p + header.vertBytes, header.vertBytes);
+			if (((*edges)[i].first < 1) || ((*edges)[i].first > header.numVert)
+				|| ((*edges)[i].second < 1) || ((*edges)[i].second > maxNeighbour)) return false;
+		}
+		if (edgeWeights)
+		{
+			edgeWeights->assign(header.numEdges, W());
+			if (CsrGraph<V, W>::weighted && (header.weightBytes > 0))
+			{
+				for (size_t i = 0; i < header.numEdges; ++i)
+				{
+					StoreWeight((*edgeWeights)[i], LoadPackedSigned(base + offEdgeW + i * header.weightBytes, header.weightBytes));
+				}
+			}
+		}
+	}
+	return true;
+}
@@ -0,0 +1,131 @@
+// Log.h: уровни вывода и буферизованный поток результата для Combi18, Combi23 и Combi51, только заголовок.
+// result -- только ответ (по умолчанию), summary -- еще имя файла, размеры графа и итоги этапов,
+// trace -- ход алгоритма и распечатки графа. Трассировка есть только в отладочной сборке (без NDEBUG)
+// или при COMBI_TRACE; в выпускной сборке LOG_TRACE не порождает кода, а блоки под TraceOn() выбрасываются.
+// Все печатается через Out(): буфер 64 КБ сбрасывается целиком, а не после каждой строки.
+// Числовые ключи командной строки (--threads=N и т.п.) разбирает ParseCountOption: не число -- ключ
+// пропускается с сообщением, как неизвестный
+
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+enum LogLevel
+{
+	LogResult = 0,
+	LogSummary = 1,
+	LogTrace = 2
+};
+
+#if !defined(NDEBUG) || defined(COMBI_TRACE)
+#define COMBI_TRACE_ENABLED 1
+#else
+#define COMBI_TRACE_ENABLED 0
+#endif
+
+inline int& CurrentLogLevel()
+{
+	static int level = LogResult;
+	return level;
+}
+
+inline bool LogOn(int level) { return CurrentLogLevel() >= level; }
+
+inline bool TraceOn() { return COMBI_TRACE_ENABLED && LogOn(LogTrace); }
+
+inline bool SetLogLevel(std::string const& name) // --log=result|summary|trace
+{
+	if (name == "result") CurrentLogLevel() = LogResult;
+	else if (name == "summary") CurrentLogLevel() = LogSummary;
+	else if (name == "trace") CurrentLogLevel() = LogTrace;
+	else return false;
+	return true;
+}
+
+inline bool ParseCount(char const* text, size_t& value, size_t minimum = 1)	// десятичное число >= minimum
+{	// целиком, без знака и пробелов
+	if ((*text < '0') || (*text > '9')) return false;
+	char* end = nullptr;
+	errno = 0;
+	unsigned long long number = std::strtoull(text, &end, 10);
+	if ((*end != '\0') || (errno == ERANGE) || (number < minimum) || (number > SIZE_MAX)) return false;
+	value = (size_t)number;
+	return true;
+}
+
+class OutBuffer : public std::streambuf	// буфер над stdout: fwrite большими кусками
+{
+public:
+	OutBuffer() { setp(buf, buf + sizeof(buf)); }
+	~OutBuffer() { sync(); }
+
+protected:
+	int_type overflow(int_type ch) override
+	{
+		Drain();
+		if (traits_type::eq_int_type(ch, traits_type::eof())) return traits_type::not_eof(ch);
+		*pptr() = traits_type::to_char_type(ch);
+		pbump(1);
+		return ch;
+	}
+
+	std::streamsize xsputn(char const* s, std::streamsize n) override
+	{
+		if (n > epptr() - pptr())
+		{
+			Drain();
+			if (n > epptr() - pptr()) return (std::streamsize)std::fwrite(s, 1, (size_t)n, stdout);
+		}
+		std::char_traits<char>::copy(pptr(), s, (size_t)n);
+		pbump((int)n);
+		return n;
+	}
+
+	int sync() override
+	{
+		Drain();
+		return std::fflush(stdout);
+	}
+
+private:
+	void Drain()
+	{
+		if (pptr() > pbase()) std::fwrite(pbase(), 1, pptr() - pbase(), stdout);
+		setp(buf, buf + sizeof(buf));
+	}
+
+	char buf[1 << 16];
+};
+
+inline std::ostream& Out()
+{
+	static OutBuffer buffer;
+	static std::ostream out(&buffer);
+	return out;
+}
+
+inline bool ParseCountOption(std::string const& arg, char const* prefix, size_t& value, size_t minimum = 1)
+{	// prefix -- "--имя="; false -- ключ другой. Неверное число печатается, value остается прежним
+	size_t length = std::strlen(prefix);
+	if (arg.compare(0, length, prefix) != 0) return false;
+	if (!ParseCount(arg.c_str() + length, value, minimum))
+	{
+		Out() << "Bad value in " << arg << ": number from " << minimum << " expected, option ignored\n";
+	}
+	return true;
+}
+
+#define LOG_SUMMARY(expr) do { if (LogOn(LogSummary)) Out() << expr; } while (0)
+
+#if COMBI_TRACE_ENABLED
+#define LOG_TRACE(expr) do { if (TraceOn()) Out() << expr; } while (0)
+#else
+#define LOG_TRACE(expr) do {} while (0)
+#endif
@@ -0,0 +1,325 @@
+// MemStats.h: учет памяти по подсистемам и ограничение --mem-limit, только заголовок.
+// Учет включается при сборке определением COMBI_MEM_STATS (cmake -DCOMBI_MEM_STATS=ON, в Visual Studio --
+// в определениях препроцессора проекта): MEM_STATS_HOOKS() рядом с main подменяет глобальные operator new/delete,
+// каждый блок несет заголовок с размером и подсистемой, выделившей его. Подсистему задает MEM_SCOPE(MemGraph)
+// до конца блока; блок возвращается на счет своей подсистемы, где бы его ни освободили. Без COMBI_MEM_STATS
+// подмены нет, MEM_SCOPE пуст, и учет ничего не стоит.
+// --mem-stats: при выходе из main (MemoryReport) таблица -- по подсистемам число выделений, пик и остаток
+// кучи; и пиковый RSS процесса, его ОС меряет и без учета.
+// --mem-limit=N[K|M|G]: с учетом выделение сверх N байт кучи отказывает (std::bad_alloc) точно по счетчику.
+// Без учета ограничение ставит ОС: под Linux RLIMIT_DATA (ядро 4.7+: куча, анонимные отображения, стеки
+// потоков), под Windows -- объект задания с ProcessMemoryLimit. bad_alloc программы ловят: main -- сообщением
+// MemoryExhausted и кодом 1, пакетный режим -- ответом "memory limit exceeded" на граф, демон -- ответом
+// на запрос; Combi51 вместо этого переходит на --stream, если может (приближенный ответ, код 2)
+
+#pragma once
+
+#include "Log.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+enum MemSubsystem
+{
+	MemOther = 0,					// вне MEM_SCOPE: разбор ключей, потоки, буферы вывода
+	MemGraph,						// чтение и хранение графа
+	MemSolver,						// рабочая память алгоритма
+	MemOutput,						// ответ и его печать
+	MemCache,						// кэш ответов
+	MEM_NUM
+};
+
+inline char const* MemSubsystemName(int subsystem)
+{
+	static char const* const names[MEM_NUM] = { "other", "graph", "solver", "output", "cache" };
+	return names[subsystem];
+}
+
+struct MemCounters
+{
+	std::atomic<size_t> allocations;
+	std::atomic<size_t> live;		// байт кучи сейчас
+	std::atomic<size_t> peak;
+};
+
+struct MemoryState
+{
+	bool report = false;			// --mem-stats
+	size_t limit = 0;				// --mem-limit, байт; 0 -- без ограничения
+	MemCounters total;
+	MemCounters subsystems[MEM_NUM];
+	std::atomic<size_t> refused;	// выделений, отказанных из-за limit
+	std::atomic<int> refusedIn;		// подсистема последнего отказа
+};
+
+inline MemoryState& Memory()
+{
+	static MemoryState state;
+	return state;
+}
+
+inline bool MemoryCounted()
+{
+#ifdef COMBI_MEM_STATS
+	return true;
+#else
+	return false;
+#endif
+}
+
+inline int& MemTag()
+{
+	thread_local int tag = MemOther;
+	return tag;
+}
+
+class MemScope
+{
+public:
+	explicit MemScope(int subsystem) : saved(MemTag()) { MemTag() = subsystem; }
+	~MemScope() { MemTag() = saved; }
+
+	MemScope(MemScope const&) = delete;
+	MemScope& operator=(MemScope const&) = delete;
+
+private:
+	int saved;
+};
+
+#define MEM_CONCAT2(a, b) a##b
+#define MEM_CONCAT(a, b) MEM_CONCAT2(a, b)
+#ifdef COMBI_MEM_STATS
+#define MEM_SCOPE(subsystem) MemScope MEM_CONCAT(memScope, __LINE__)(subsystem)
+#else
+#define MEM_SCOPE(subsystem)
+#endif
+
+static const size_t MEM_HEADER = 16;	// размер и подсистема блока; 16 -- чтобы не сбить выравнивание malloc
+
+inline void MemPeak(MemCounters& counters, size_t now)
+{
+	size_t peak = counters.peak.load(std::memory_order_relaxed);
+	while ((now > peak) && !counters.peak.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {}
+}
+
+inline void MemAdd(MemCounters& counters, size_t size)
+{
+	MemPeak(counters, counters.live.fetch_add(size, std::memory_order_relaxed) + size);
+}
+
+inline void* MemAllocate(size_t size, bool nothrow)
+{	// место под блок занимается на счетчике до проверки предела одним fetch_add и при отказе возвращается:
+	// параллельные выделения не проскочат limit вместе, как при отдельных чтении и прибавлении
+	MemoryState& state = Memory();
+	int tag = MemTag();
+	size_t now = state.total.live.fetch_add(size, std::memory_order_relaxed) + size;
+	bool fits = (now >= size) && (size <= SIZE_MAX - MEM_HEADER) && ((state.limit == 0) || (now <= state.limit));
+	char* block = fits ? static_cast<char*>(std::malloc(size + MEM_HEADER)) : nullptr;
+	if (!block)
+	{
+		state.total.live.fetch_sub(size, std::memory_order_relaxed);
+		if (!fits)
+		{
+			state.refused++;
+			state.refusedIn = tag;
+		}
+		if (nothrow) return nullptr;
+		throw std::bad_alloc();
+	}
+	reinterpret_cast<size_t*>(block)[0] = size;
+	reinterpret_cast<size_t*>(block)[1] = tag;
+	state.total.allocations.fetch_add(1, std::memory_order_relaxed);
+	MemPeak(state.total, now);
+	state.subsystems[tag].allocations.fetch_add(1, std::memory_order_relaxed);
+	MemAdd(state.subsystems[tag], size);
+	return block + MEM_HEADER;
+}
+
+inline void MemFree(void* p)
+{
+	if (!p) return;
+	char* block = static_cast<char*>(p) - MEM_HEADER;
+	size_t size = reinterpret_cast<size_t*>(block)[0];
+	size_t tag = reinterpret_cast<size_t*>(block)[1];
+	MemoryState& state = Memory();
+	state.total.live.fetch_sub(size, std::memory_order_relaxed);
+	state.subsystems[tag].live.fetch_sub(size, std::memory_order_relaxed);
+	std::free(block);
+}
+
+#ifdef COMBI_MEM_STATS
+#define MEM_STATS_HOOKS() \
+	void* operator new(size_t size) { return MemAllocate(size, false); } \
+	void* operator new[](size_t size) { return MemAllocate(size, false); } \
+	void* operator new(size_t size, std::nothrow_t const&) noexcept { return MemAllocate(size, true); } \
+	void* operator new[](size_t size, std::nothrow_t const&) noexcept { return MemAllocate(size, true); } \
+	void operator delete(void* p) noexcept { MemFree(p); } \
+	void operator delete[](void* p) noexcept { MemFree(p); } \
+	void operator delete(void* p, size_t) noexcept { MemFree(p); } \
+	void operator delete[](void* p, size_t) noexcept { MemFree(p); } \
+	void operator delete(void* p, std::nothrow_t const&) noexcept { MemFree(p); } \
+	void operator delete[](void* p, std::nothrow_t const&) noexcept { MemFree(p); }
+#else
+#define MEM_STATS_HOOKS()
+#endif
+
+inline size_t PeakRssBytes()		// 0 -- ОС не сказала
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+	return counters.PeakWorkingSetSize;
+#else
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+	return usage.ru_maxrss;
+#else
+	return (size_t)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+inline std::string FormatBytes(size_t bytes)
+{
+	char text[32];
+	if (bytes >= (size_t(1) << 30)) std::snprintf(text, sizeof(text), "%.1f GB", bytes / double(size_t(1) << 30));
+	else if (bytes >= (size_t(1) << 20)) std::snprintf(text, sizeof(text), "%.1f MB", bytes / double(size_t(1) << 20));
+	else if (bytes >= 1024) std::snprintf(text, sizeof(text), "%.1f KB", bytes / 1024.0);
+	else std::snprintf(text, sizeof(text), "%u bytes", (unsigned)bytes);
+	return text;
+}
+
+inline bool ParseByteSize(char const* text, size_t& bytes)	// "64M", "2G", "500000"; false -- не число,
+{	// чужой суффикс или больше SIZE_MAX
+	if ((*text < '0') || (*text > '9')) return false;
+	char* end = nullptr;
+	errno = 0;
+	unsigned long long number = std::strtoull(text, &end, 10);
+	if (errno == ERANGE) return false;
+	int shift = 0;
+	switch (*end)
+	{
+	case 'G': case 'g': shift = 30; ++end; break;
+	case 'M': case 'm': shift = 20; ++end; break;
+	case 'K': case 'k': shift = 10; ++end; break;
+	default: break;
+	}
+	if ((*end != '\0') || (number > (SIZE_MAX >> shift))) return false;
+	bytes = (size_t)number << shift;
+	return true;
+}
+
+inline void SetMemoryLimit(size_t bytes)
+{
+	Memory().limit = bytes;
+	if (MemoryCounted() || (bytes == 0)) return;	// куча считается точно, ОС не нужна
+#ifdef _WIN32
+	HANDLE job = CreateJobObject(nullptr, nullptr);
+	JOBOBJECT_EXTENDED_LIMIT_INFORMATION info = {};
+	info.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_PROCESS_MEMORY;
+	info.ProcessMemoryLimit = bytes;
+	bool set = job && SetInformationJobObject(job, JobObjectExtendedLimitInformation, &info, sizeof(info))
+		&& AssignProcessToJobObject(job, GetCurrentProcess());
+#else
+	rlimit limit;
+	bool set = (getrlimit(RLIMIT_DATA, &limit) == 0);
+	if (set)
+	{
+		limit.rlim_cur = ((limit.rlim_max == RLIM_INFINITY) || (bytes < limit.rlim_max)) ? bytes : limit.rlim_max;
+		set = (setrlimit(RLIMIT_DATA, &limit) == 0);
+	}
+#endif
+	if (!set) Out() << "--mem-limit: the system refused the limit, running without it\n";
+}
+
+inline bool ParseMemoryOption(std::string const& arg)
+{	// --mem-stats, --mem-limit=N[K|M|G]; true -- ключ разобран
+	if (arg == "--mem-stats") Memory().report = true;
+	else if (arg.compare(0, 12, "--mem-limit=") == 0)
+	{	// неверный размер -- сообщение, как у ParseCountOption, и ключ пропускается
+		size_t bytes = 0;
+		if (ParseByteSize(arg.c_str() + 12, bytes)) SetMemoryLimit(bytes);
+		else Out() << "Bad value in " << arg << ": size N[K|M|G] expected, option ignored\n";
+	}
+	else return false;
+	return true;
+}
+
+inline std::string MemorySummary()	// одна строка: пиковый RSS и, с учетом, куча
+{
+	MemoryState& state = Memory();
+	std::string summary = "peak RSS " + FormatBytes(PeakRssBytes());
+	if (MemoryCounted())
+	{
+		summary += ", heap " + FormatBytes(state.total.live) + " live, " + FormatBytes(state.total.peak) + " peak";
+	}
+	if (state.limit > 0) summary += ", limit " + FormatBytes(state.limit);
+	return summary;
+}
+
+inline std::string MemoryExhaustedMessage()
+{	// после std::bad_alloc: чья память кончилась
+	MemoryState& state = Memory();
+	std::string message = (state.limit > 0) ? "Memory limit of " + FormatBytes(state.limit) + " exceeded" : "Out of memory";
+	if (state.refused > 0) message += std::string(" while allocating for ") + MemSubsystemName(state.refusedIn);
+	return message + " (" + MemorySummary() + ")";
+}
+
+inline void MemoryExhausted()
+{
+	Out() << "\n" << MemoryExhaustedMessage() << std::endl;
+}
+
+inline void PrintMemoryStats()
+{
+	MemoryState& state = Memory();
+	Out() << "\nMemory";
+	if (!MemoryCounted()) Out() << " (allocation counting is off: build with COMBI_MEM_STATS)";
+	Out() << ":\n";
+	char line[256];
+	if (MemoryCounted())
+	{
+		std::snprintf(line, sizeof(line), "%-12s %12s %14s %14s\n", "subsystem", "allocations", "peak KB", "live KB");
+		Out() << line;
+		for (int s = 0; s <= MEM_NUM; ++s)
+		{
+			MemCounters& counters = (s < MEM_NUM) ? state.subsystems[s] : state.total;
+			if ((s < MEM_NUM) && (counters.allocations == 0)) continue;
+			std::snprintf(line, sizeof(line), "%-12s %12llu %14.1f %14.1f\n", (s < MEM_NUM) ? MemSubsystemName(s) : "total",
+				(unsigned long long)counters.allocations, counters.peak / 1024.0, counters.live / 1024.0);
+			Out() << line;
+		}
+		if (state.refused > 0) Out() << "refused by --mem-limit: " << state.refused << "\n";
+	}
+	std::snprintf(line, sizeof(line), "peak RSS %.1f KB\n", PeakRssBytes() / 1024.0);
+	Out() << line;
+	Out().flush();
+}
+
+struct MemoryReport					// в начале main: при выходе из main печатает таблицу, если был --mem-stats
+{
+	~MemoryReport()
+	{
+		if (Memory().report) PrintMemoryStats();
+	}
+};
@@ -0,0 +1,335 @@
+// Profile.h: ключ --profile -- время и аппаратные счетчики по этапам решения, только заголовок.
+// PROFILE_PHASE("имя") в начале блока делает остаток блока этапом. Без --profile это одна проверка флага.
+// Под Linux этап меряет еще и счетчики процессора (perf_event_open, только пользовательский режим): такты,
+// инструкции, промахи L1d и последнего уровня кэша, неугаданные переходы. Счетчики открываются группой
+// в каждом потоке при первом этапе; если ядро их не дает (perf_event_paranoid, виртуальная машина без PMU,
+// не Linux), остается только время, и таблица говорит почему. Недоступный отдельный счетчик -- прочерк.
+// Таблица печатается через Out() при выходе из main (ProfileReport): этапы в порядке первого входа,
+// вложенные -- с отступом; числа вложенного этапа входят и в объемлющий. Потоки пакетного режима
+// меряют каждый себя, итоги по этапу складываются.
+// Этапы стоят и в горячих циклах, поэтому вход и выход блокировок не берут: номер этапа запоминается
+// в статической переменной места PROFILE_PHASE (общий список этапов -- под мьютексом, только при первом
+// входе), итоги копятся в итогах потока (ThreadProfile) и сливаются в общие при выходе потока
+// или перед печатью таблицы
+
+#pragma once
+
+#include "Log.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+enum ProfileCounter
+{
+	CntCycles = 0,
+	CntInstructions,
+	CntL1Misses,
+	CntLlcMisses,
+	CntBranchMisses,
+	CNT_NUM
+};
+
+struct PhaseTotals
+{
+	unsigned long long calls = 0;
+	double seconds = 0;
+	double counters[CNT_NUM] = {};
+
+	void Add(PhaseTotals const& other)
+	{
+		calls += other.calls;
+		seconds += other.seconds;
+		for (int c = 0; c < CNT_NUM; ++c) counters[c] += other.counters[c];
+	}
+};
+
+struct PhaseProfile
+{
+	std::string name;
+	int depth = 0;					// вложенность при первом входе
+	PhaseTotals totals;				// слитые итоги потоков
+};
+
+struct ProfileState
+{
+	bool enabled = false;
+	std::mutex lock;
+	std::vector<PhaseProfile> phases;
+	bool counted[CNT_NUM] = {};		// счетчик работал хотя бы в одном потоке
+	std::string unavailable;		// почему счетчиков нет
+};
+
+struct PhaseSite					// место PROFILE_PHASE: номер этапа находится один раз
+{
+	char const* name;
+	std::atomic<int> index;			// -1 -- этап еще не заведен
+
+	constexpr explicit PhaseSite(char const* phaseName) : name(phaseName), index(-1) {}
+};
+
+inline ProfileState& Profile()
+{
+	static ProfileState state;
+	return state;
+}
+
+inline bool ProfileOn() { return Profile().enabled; }
+
+class PerfGroup						// счетчики вызывающего потока; Read -- текущие значения, с поправкой на мультиплексирование
+{
+public:
+	PerfGroup()
+	{
+		for (int c = 0; c < CNT_NUM; ++c) fd[c] = slot[c] = -1;
+#ifdef __linux__
+		static const uint32_t types[CNT_NUM] = { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+			PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE };
+		static const uint64_t configs[CNT_NUM] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+			PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+			PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+		for (int c = 0; c < CNT_NUM; ++c)
+		{
+			perf_event_attr attr;
+			std::memset(&attr, 0, sizeof(attr));
+			attr.size = sizeof(attr);
+			attr.type = types[c];
+			attr.config = configs[c];
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+			fd[c] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, leader, 0);
+			if (fd[c] < 0)
+			{
+				if (error.empty()) error = std::strerror(errno);
+				continue;
+			}
+			if (leader < 0) leader = fd[c];
+			slot[c] = members++;
+		}
+		if (leader >= 0) error.clear();
+#else
+		error = "no perf_event_open on this system";
+#endif
+	}
+
+	~PerfGroup()
+	{
+#ifdef __linux__
+		for (int c = 0; c < CNT_NUM; ++c)
+		{
+			if (fd[c] >= 0) close(fd[c]);
+		}
+#endif
+	}
+
+	PerfGroup(PerfGroup const&) = delete;
+	PerfGroup& operator=(PerfGroup const&) = delete;
+
+	bool Available(int c) const { return fd[c] >= 0; }
+	std::string const& Error() const { return error; }
+
+	void Read(double values[CNT_NUM]) const
+	{
+		for (int c = 0; c < CNT_NUM; ++c) values[c] = 0;
+#ifdef __linux__
+		if (leader < 0) return;
+		uint64_t buf[3 + CNT_NUM];		// число счетчиков, время включения, время работы, значения
+		if (read(leader, buf, sizeof(buf)) < (ssize_t)(3 * sizeof(uint64_t))) return;
+		double scale = (buf[2] > 0) ? (double)buf[1] / buf[2] : 0;
+		for (int c = 0; c < CNT_NUM; ++c)
+		{
+			if (slot[c] >= 0) values[c] = buf[3 + slot[c]] * scale;
+		}
+#endif
+	}
+
+private:
+	int fd[CNT_NUM];
+	int slot[CNT_NUM];				// место счетчика в ответе read группы
+	int leader = -1;
+	int members = 0;
+	std::string error;
+};
+
+inline PerfGroup& ThreadPerfGroup()
+{
+	thread_local PerfGroup group;
+	return group;
+}
+
+inline int& ProfileDepth()
+{
+	thread_local int depth = 0;
+	return depth;
+}
+
+inline size_t FindPhase(char const* name, int depth)
+{	// этап заводится при первом входе, чтобы объемлющий этап стоял в таблице раньше вложенных.
+	// Один раз на место PROFILE_PHASE (см. PhaseSite); у разных мест с одним именем -- один этап
+	ProfileState& state = Profile();
+	std::lock_guard<std::mutex> guard(state.lock);
+	for (size_t i = 0; i < state.phases.size(); ++i)
+	{
+		if (state.phases[i].name == name) return i;
+	}
+	state.phases.emplace_back();
+	state.phases.back().name = name;
+	state.phases.back().depth = depth;
+	return state.phases.size() - 1;
+}
+
+struct ThreadProfile				// итоги этапов одного потока; общий список сливает их под мьютексом
+{
+	std::vector<PhaseTotals> phases;	// по номерам этапов Profile().phases
+	bool used = false;				// был хотя бы один этап
+
+	void Merge()
+	{
+		if (!used) return;
+		ProfileState& state = Profile();
+		std::lock_guard<std::mutex> guard(state.lock);
+		for (size_t i = 0; i < phases.size(); ++i) state.phases[i].totals.Add(phases[i]);
+		PerfGroup const& group = ThreadPerfGroup();
+		for (int c = 0; c < CNT_NUM; ++c)
+		{
+			if (group.Available(c)) state.counted[c] = true;
+		}
+		if (state.unavailable.empty()) state.unavailable = group.Error();
+		phases.clear();
+		used = false;
+	}
+
+	~ThreadProfile() { Merge(); }	// поток кончается раньше, чем join в нем возвращается
+};
+
+inline ThreadProfile& ThreadPhases()
+{
+	thread_local ThreadProfile profile;
+	return profile;
+}
+
+class ScopedPhase
+{
+public:
+	explicit ScopedPhase(PhaseSite& site) : active(ProfileOn())
+	{
+		if (!active) return;
+		int depth = ProfileDepth()++;
+		int known = site.index.load(std::memory_order_acquire);
+		if (known < 0)
+		{	// два потока могут завести этап одновременно -- FindPhase даст обоим один номер
+			known = (int)FindPhase(site.name, depth);
+			site.index.store(known, std::memory_order_release);
+		}
+		index = (size_t)known;
+		ThreadPerfGroup().Read(start);
+		startTime = std::chrono::steady_clock::now();
+	}
+
+	~ScopedPhase()
+	{
+		if (!active) return;
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+		double end[CNT_NUM];
+		ThreadPerfGroup().Read(end);
+		--ProfileDepth();
+		ThreadProfile& profile = ThreadPhases();
+		if (profile.phases.size() <= index) profile.phases.resize(index + 1);
+		PhaseTotals& phase = profile.phases[index];
+		phase.calls++;
+		phase.seconds += seconds;
+		for (int c = 0; c < CNT_NUM; ++c) phase.counters[c] += end[c] - start[c];
+		profile.used = true;
+	}
+
+	ScopedPhase(ScopedPhase const&) = delete;
+	ScopedPhase& operator=(ScopedPhase const&) = delete;
+
+private:
+	bool active;
+	size_t index = 0;				// номер этапа в Profile().phases
+	double start[CNT_NUM];
+	std::chrono::steady_clock::time_point startTime;
+};
+
+#define PROFILE_CONCAT2(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT2(a, b)
+#define PROFILE_PHASE(name) \
+	static PhaseSite PROFILE_CONCAT(profileSite, __LINE__)(name); \
+	ScopedPhase PROFILE_CONCAT(profilePhase, __LINE__)(PROFILE_CONCAT(profileSite, __LINE__))
+
+inline void PrintProfile()
+{	// потоки пакетного режима уже слили свои итоги при выходе, осталось -- этот поток
+	ThreadPhases().Merge();
+	ProfileState& state = Profile();
+	std::lock_guard<std::mutex> guard(state.lock);
+	bool anyCounter = false;
+	for (int c = 0; c < CNT_NUM; ++c) anyCounter = anyCounter || state.counted[c];
+	Out() << "\nProfile";
+	if (!anyCounter) Out() << " (time only: hardware counters unavailable" << (state.unavailable.empty() ? "" : ": ")
+		<< state.unavailable << ")";
+	Out() << ":\n";
+
+	char line[256];
+	std::snprintf(line, sizeof(line), "%-24s %9s %12s", "phase", "calls", "ms");
+	Out() << line;
+	if (anyCounter)
+	{
+		std::snprintf(line, sizeof(line), " %14s %14s %6s %12s %12s %12s", "cycles", "instructions", "IPC",
+			"L1d misses", "LLC misses", "br misses");
+		Out() << line;
+	}
+	Out() << "\n";
+	for (auto& phase : state.phases)
+	{
+		std::string name = std::string(2 * phase.depth, ' ') + phase.name;
+		PhaseTotals const& totals = phase.totals;
+		std::snprintf(line, sizeof(line), "%-24s %9llu %12.3f", name.c_str(), totals.calls, totals.seconds * 1e3);
+		Out() << line;
+		if (anyCounter)
+		{
+			for (int c = 0; c < CNT_NUM; ++c)
+			{
+				if (c == CntL1Misses)
+				{
+					bool ipc = state.counted[CntCycles] && state.counted[CntInstructions] && (totals.counters[CntCycles] > 0);
+					if (ipc) std::snprintf(line, sizeof(line), " %6.2f", totals.counters[CntInstructions] / totals.counters[CntCycles]);
+					else std::snprintf(line, sizeof(line), " %6s", "-");
+					Out() << line;
+				}
+				int width = (c < CntL1Misses) ? 14 : 12;
+				if (state.counted[c]) std::snprintf(line, sizeof(line), " %*.0f", width, totals.counters[c]);
+				else std::snprintf(line, sizeof(line), " %*s", width, "-");
+				Out() << line;
+			}
+		}
+		Out() << "\n";
+	}
+	Out().flush();
+}
+
+inline void EnableProfile()
+{
+	Profile().enabled = true;
+}
+
+struct ProfileReport				// в начале main: при выходе из main печатает таблицу, если был --profile
+{
+	~ProfileReport()
+	{
+		if (ProfileOn()) PrintProfile();
+	}
+};
@@ -0,0 +1,188 @@
+// Relabel.h: перенумерация вершин для локальности обхода смежности, только заголовок.
+// Номера вершин приходят из файла как есть; на больших графах соседи вершины разбросаны по всем массивам,
+// и обход (поиск увеличивающей цепи в Combi51, поиск в ширину компонент в Combi23) прыгает по памяти.
+// Ключ --relabel=... после чтения графа строит новый порядок вершин, решатель работает на переставленной
+// CSR (PermuteCsr, см. CsrGraph.h), ответ переводится обратно в номера файла:
+//   bfs -- обход в ширину от вершины 1 (следующая компонента -- от первой непосещенной): соседи получают
+//     близкие номера;
+//   rcm -- обратный порядок Катхилла-Макки: обход в ширину от вершины наименьшей степени, соседи -- по
+//     возрастанию степени, весь порядок обращается; у матрицы смежности получается узкая лента;
+//   degree -- по убыванию степени: смежность вершин, к которым обход приходит чаще всего, лежит вместе.
+// Ответ остается верным (размер паросочетания, плоскость графа), но из равноценных может найтись другой.
+// Перестановка стоит O(V + E) времени и копию смежности; окупается ли она -- видно в --profile (этап relabel)
+// и в бенчмарках (bench23, bench51 --relabel=none,rcm)
+
+#pragma once
+
+#include "CsrGraph.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum RelabelKind
+{
+	RelabelNone = 0,
+	RelabelBfs,
+	RelabelRcm,
+	RelabelDegree
+};
+
+inline char const* RelabelName(RelabelKind kind)
+{
+	static char const* const names[] = { "none", "bfs", "rcm", "degree" };
+	return names[kind];
+}
+
+inline bool ParseRelabel(std::string const& name, RelabelKind& kind)	// false -- нет такого порядка
+{
+	for (int k = RelabelNone; k <= RelabelDegree; ++k)
+	{
+		if (name == RelabelName((RelabelKind)k))
+		{
+			kind = (RelabelKind)k;
+			return true;
+		}
+	}
+	return false;
+}
+
+inline bool ParseRelabelOption(std::string const& arg, RelabelKind& kind)	// --relabel=bfs|rcm|degree|none
+{
+	return (arg.compare(0, 10, "--relabel=") == 0) && ParseRelabel(arg.substr(10), kind);
+}
+
+template <typename V>
+struct Relabeling					// перестановка вершин одной доли; буферы переиспользуются от графа к графу
+{
+	std::vector<V> order;			// order[новый номер] -- номер во входе; order[0] = 0
+	std::vector<V> newNumber;		// обратная перестановка
+
+	void Invert()
+	{
+		newNumber.assign(order.size(), 0);
+		for (size_t i = 1; i < order.size(); ++i) newNumber[order[i]] = (V)i;
+	}
+};
+
+template <typename V, typename Degree>
+void DegreeSorted(size_t numVert, Degree degree, bool descending, std::vector<V>& verts)
+{	// вершины 1..numVert сортировкой подсчетом по степени; при равной степени -- по номеру
+	size_t maxDeg = 0;
+	for (size_t v = 1; v <= numVert; ++v) maxDeg = std::max(maxDeg, degree(v));
+	auto key = [&](size_t v) { return descending ? maxDeg - degree(v) : degree(v); };
+	std::vector<size_t> first(maxDeg + 2, 0);
+	for (size_t v = 1; v <= numVert; ++v) first[key(v) + 1]++;
+	for (size_t d = 1; d <= maxDeg + 1; ++d) first[d] += first[d - 1];
+	verts.resize(numVert);
+	for (size_t v = 1; v <= numVert; ++v) verts[first[key(v)]++] = (V)v;
+}
+
+template <typename V, typename Degree, typename Neighbours>
+void LocalityOrder(size_t numVert, Degree degree, Neighbours neighbours, RelabelKind kind, std::vector<V>& order)
+{	// order[новый номер] -- старый номер. Граф неориентированный, задан функциями: degree(v) и neighbours(v) --
+	// диапазон соседей v
+	order.clear();
+	order.reserve(numVert + 1);
+	order.push_back(0);
+	std::vector<V> roots;			// откуда начинается обход очередной компоненты
+	if ((kind == RelabelRcm) || (kind == RelabelDegree))
+	{
+		DegreeSorted(numVert, degree, kind == RelabelDegree, roots);
+	}
+	else
+	{
+		for (size_t v = 1; v <= numVert; ++v) roots.push_back((V)v);
+	}
+	if ((kind == RelabelNone) || (kind == RelabelDegree))
+	{
+		order.insert(order.end(), roots.begin(), roots.end());
+		return;
+	}
+
+	std::vector<char> seen(numVert + 1, 0);
+	for (V root : roots)
+	{
+		if (seen[root]) continue;
+		seen[root] = 1;
+		order.push_back(root);
+		for (size_t head = order.size() - 1; head < order.size(); ++head)
+		{
+			size_t first = order.size();
+			for (V u : neighbours(order[head]))
+			{
+				if (seen[u]) continue;
+				seen[u] = 1;
+				order.push_back(u);
+			}
+			if (kind == RelabelRcm)
+			{
+				std::sort(order.begin() + first, order.end(), [&degree](V a, V b)
+				{
+					size_t da = degree(a);
+					size_t db = degree(b);
+					return (da < db) || ((da == db) && (a < b));
+				});
+			}
+		}
+	}
+	if (kind == RelabelRcm) std::reverse(order.begin() + 1, order.end());
+}
+
+template <typename V, typename W>
+void LocalityOrder(CsrGraph<V, W> const& graph, RelabelKind kind, std::vector<V>& order)
+{	// graph неориентированный (сосед есть у обоих концов ребра)
+	LocalityOrder(graph.numVert, [&graph](size_t v) { return graph.Degree(v); },
+		[&graph](size_t v) { return graph.Neighbours(v); }, kind, order);
+}
+
+template <typename V>
+struct JointNeighbours				// соседи вершины общего графа двух долей: номера второй доли сдвинуты на shift
+{
+	V const* first;
+	V const* last;
+	size_t shift;
+
+	struct Iterator
+	{
+		V const* at;
+		size_t shift;
+
+		V operator*() const { return (V)(*at + shift); }
+		Iterator& operator++() { ++at; return *this; }
+		bool operator!=(Iterator const& other) const { return at != other.at; }
+	};
+
+	Iterator begin() const { return { first, shift }; }
+	Iterator end() const { return { last, shift }; }
+};
+
+template <typename V, typename W>
+void BipartiteLocalityOrder(CsrGraph<V, W> const& graph, size_t numVert2, RelabelKind kind,
+	Relabeling<V>& part1, Relabeling<V>& part2)
+{	// строки graph -- первая доля, соседи -- вторая. Порядок строится на общем неориентированном графе
+	// (вершина v второй доли в нем -- numVert1 + v; ее соседи -- обратные дуги) и делится по долям
+	size_t numVert1 = graph.numVert;
+	CsrGraph<V, W> rev;
+	BuildTransposed(graph, numVert2, rev);
+	std::vector<V> order;
+	LocalityOrder(numVert1 + numVert2,
+		[&](size_t v) { return (v <= numVert1) ? graph.Degree(v) : rev.Degree(v - numVert1); },
+		[&](size_t v)
+		{
+			NeighSpan<V> span = (v <= numVert1) ? graph.Neighbours(v) : rev.Neighbours(v - numVert1);
+			return JointNeighbours<V>{ span.first, span.last, (v <= numVert1) ? numVert1 : 0 };
+		},
+		kind, order);
+
+	part1.order.assign(1, 0);
+	part2.order.assign(1, 0);
+	for (size_t i = 1; i < order.size(); ++i)
+	{
+		if (order[i] <= numVert1) part1.order.push_back(order[i]);
+		else part2.order.push_back((V)(order[i] - numVert1));
+	}
+	part1.Invert();
+	part2.Invert();
+}
@@ -0,0 +1,457 @@
+// ResultCache.h: кэш ответов решателей по содержимому графа, только заголовок.
+// Ключ -- 128-битный хэш алгоритма с опциями, размеров графа и списка ребер со стоимостями, отсортированного
+// по возрастанию: один и тот же граф с ребрами в другом порядке дает тот же ключ. Значение -- строка ответа
+// (как в пакетном режиме и у CombiDaemon).
+// Два уровня: в памяти -- LRU на заданное число ответов; на диске (если задан каталог) -- индекс
+// index.dat, отображенный в память (открытая адресация, при заполнении на 3/4 перестраивается вдвое большим),
+// и ответы подряд в results.dat. Дисковый кэш рассчитан на один процесс; внутри процесса все под мьютексом.
+// Индексу при открытии не доверяем: размер таблицы и numUsed сверяются с файлом, ячейки, указывающие за конец
+// results.dat, очищаются. Если индекс не удалось перестроить, кэш остается с прежней таблицей и перестает
+// записывать новые ответы на диск (об этом печатается строка)
+// Счетчики попаданий и промахов -- Hits(), DiskHits(), Misses()
+
+#pragma once
+
+#include "GraphIo.h"
+#include "Log.h"
+#include "MemStats.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+struct CacheKey
+{
+	uint64_t lo = 0;
+	uint64_t hi = 0;
+
+	bool operator==(CacheKey const& other) const { return (lo == other.lo) && (hi == other.hi); }
+	bool Empty() const { return (lo == 0) && (hi == 0); }
+};
+
+struct CacheKeyHash
+{
+	size_t operator()(CacheKey const& key) const { return (size_t)key.lo; }
+};
+
+inline uint64_t Mix64(uint64_t x)	// финальное перемешивание splitmix64
+{
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9ULL;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111ebULL;
+	x ^= x >> 31;
+	return x;
+}
+
+class GraphHasher					// две независимые 64-битные дорожки по одному потоку слов
+{
+public:
+	void Add(uint64_t x)
+	{
+		lo = Mix64(lo + x * 0x9e3779b97f4a7c15ULL);
+		hi = Mix64(hi ^ (x + 0x632be59bd9b4e019ULL));
+		++count;
+	}
+
+	void Add(std::string const& text)
+	{
+		Add(text.size());
+		for (size_t i = 0; i < text.size(); i += 8)
+		{
+			uint64_t word = 0;
+			std::memcpy(&word, text.data() + i, std::min<size_t>(8, text.size() - i));
+			Add(word);
+		}
+	}
+
+	CacheKey Key() const
+	{
+		CacheKey key;
+		key.lo = Mix64(lo ^ count);
+		key.hi = Mix64(hi + count);
+		if (key.Empty()) key.lo = 1;	// нулевой ключ -- метка пустой ячейки индекса
+		return key;
+	}
+
+private:
+	uint64_t lo = 0x243f6a8885a308d3ULL;
+	uint64_t hi = 0x13198a2e03707344ULL;
+	uint64_t count = 0;
+};
+
+typedef std::array<long long, 3> KeyEdge;	// вершина, вершина, стоимость (0, если графа без стоимостей)
+
+inline CacheKey EdgeListKey(std::string const& algorithm, std::vector<uint64_t> const& sizes, std::vector<KeyEdge>& edges)
+{	// edges сортируется на месте; неориентированные ребра вызывающий записывает меньшим концом вперед
+	std::sort(edges.begin(), edges.end());
+	GraphHasher hasher;
+	hasher.Add(algorithm);
+	hasher.Add(sizes.size());
+	for (auto size : sizes) hasher.Add(size);
+	hasher.Add(edges.size());
+	for (auto& edge : edges)
+	{
+		hasher.Add((uint64_t)edge[0]);
+		hasher.Add((uint64_t)edge[1]);
+		hasher.Add((uint64_t)edge[2]);
+	}
+	return hasher.Key();
+}
+
+struct WritableMapping				// файл заданного размера, отображенный для чтения и записи
+{
+	char* data = nullptr;
+	size_t size = 0;
+#ifdef _WIN32
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE section = nullptr;
+#else
+	int fd = -1;
+#endif
+
+	WritableMapping() = default;
+	WritableMapping(WritableMapping const&) = delete;
+	WritableMapping& operator=(WritableMapping const&) = delete;
+	~WritableMapping() { Close(); }
+
+	bool Open(std::string const& fileName, size_t minSize) // создает файл или дополняет его нулями до minSize
+	{
+		Close();
+#ifdef _WIN32
+		file = CreateFileA(fileName.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS,
+			FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return false;
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize)) return false;
+		size = std::max((size_t)fileSize.QuadPart, minSize);
+		LARGE_INTEGER mapSize;
+		mapSize.QuadPart = (LONGLONG)size;
+		section = CreateFileMappingA(file, nullptr, PAGE_READWRITE, mapSize.HighPart, mapSize.LowPart, nullptr);
+		if (section == nullptr) return false;
+		data = static_cast<char*>(MapViewOfFile(section, FILE_MAP_WRITE, 0, 0, 0));
+#else
+		fd = open(fileName.c_str(), O_RDWR | O_CREAT, 0644);
+		if (fd < 0) return false;
+		struct stat st;
+		if (fstat(fd, &st) != 0) return false;
+		size = std::max((size_t)st.st_size, minSize);
+		if (((size_t)st.st_size < size) && (ftruncate(fd, (off_t)size) != 0)) return false;
+		void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		data = (addr == MAP_FAILED) ? nullptr : static_cast<char*>(addr);
+#endif
+		return data != nullptr;
+	}
+
+	void Close()
+	{
+#ifdef _WIN32
+		if (data) UnmapViewOfFile(data);
+		if (section) CloseHandle(section);
+		if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+		section = nullptr;
+		file = INVALID_HANDLE_VALUE;
+#else
+		if (data) munmap(data, size);
+		if (fd >= 0) close(fd);
+		fd = -1;
+#endif
+		data = nullptr;
+		size = 0;
+	}
+};
+
+inline bool SeekBlob(std::FILE* f, uint64_t offset, int origin)	// смещения results.dat -- 64-битные
+{
+#ifdef _WIN32
+	return _fseeki64(f, (long long)offset, origin) == 0;
+#else
+	return fseeko(f, (off_t)offset, origin) == 0;
+#endif
+}
+
+inline long long TellBlob(std::FILE* f)
+{
+#ifdef _WIN32
+	return _ftelli64(f);
+#else
+	return (long long)ftello(f);
+#endif
+}
+
+static const char CACHE_INDEX_MAGIC[8] = { 'C', 'M', 'B', 'C', 'A', 'C', 'H', 'E' };
+static const uint32_t CACHE_INDEX_VERSION = 1;
+static const uint64_t CACHE_INDEX_MIN_SLOTS = 1 << 16;
+
+struct CacheIndexHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t reserved;
+	uint64_t numSlots;				// степень двойки
+	uint64_t numUsed;
+};
+
+struct CacheIndexSlot				// ключ 0 -- пустая ячейка
+{
+	uint64_t lo;
+	uint64_t hi;
+	uint64_t offset;				// начало ответа в results.dat
+	uint64_t length;
+};
+
+class ResultCache
+{
+public:
+	ResultCache() = default;
+	ResultCache(ResultCache const&) = delete;
+	ResultCache& operator=(ResultCache const&) = delete;
+	~ResultCache()
+	{
+		if (blobs) std::fclose(blobs);
+	}
+
+	bool Open(size_t memoryEntries, std::string const& directory)	// directory пустой -- только память
+	{
+		MEM_SCOPE(MemCache);
+		capacity = std::max<size_t>(1, memoryEntries);
+		if (directory.empty()) return true;
+#ifdef _WIN32
+		CreateDirectoryA(directory.c_str(), nullptr);
+		dir = directory + "\\";
+#else
+		mkdir(directory.c_str(), 0777);
+		dir = directory + "/";
+#endif
+		blobs = std::fopen((dir + "results.dat").c_str(), "a+b");
+		if (!blobs || !SeekBlob(blobs, 0, SEEK_END)) return false;
+		long long size = TellBlob(blobs);
+		if (size < 0) return false;
+		blobsSize = (uint64_t)size;
+		return OpenIndex(dir + "index.dat", CACHE_INDEX_MIN_SLOTS);
+	}
+
+	bool Find(CacheKey const& key, std::string& result)
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		auto found = byKey.find(key);
+		if (found != byKey.end())
+		{
+			recent.splice(recent.begin(), recent, found->second);
+			result = found->second->second;
+			++hits;
+			return true;
+		}
+		if (FindOnDisk(key, result))
+		{
+			Remember(key, result);
+			++diskHits;
+			return true;
+		}
+		++misses;
+		return false;
+	}
+
+	void Store(CacheKey const& key, std::string const& result)
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		if (byKey.count(key)) return;
+		Remember(key, result);
+		StoreOnDisk(key, result);
+	}
+
+	uint64_t Hits() const { return hits; }
+	uint64_t DiskHits() const { return diskHits; }
+	uint64_t Misses() const { return misses; }
+
+private:
+	typedef std::list<std::pair<CacheKey, std::string>> RecentList;
+
+	void Remember(CacheKey const& key, std::string const& result)
+	{	// в начало списка; самый давний ответ вытесняется
+		MEM_SCOPE(MemCache);
+		recent.emplace_front(key, result);
+		byKey[key] = recent.begin();
+		if (recent.size() > capacity)
+		{
+			byKey.erase(recent.back().first);
+			recent.pop_back();
+		}
+	}
+
+	CacheIndexHeader& Header() { return *reinterpret_cast<CacheIndexHeader*>(index.data); }
+	CacheIndexSlot* Slots() { return reinterpret_cast<CacheIndexSlot*>(index.data + sizeof(CacheIndexHeader)); }
+
+	bool OpenIndex(std::string const& fileName, uint64_t numSlots)
+	{
+		if (!index.Open(fileName, sizeof(CacheIndexHeader) + numSlots * sizeof(CacheIndexSlot))) return false;
+		CacheIndexHeader& header = Header();
+		if ((header.version == 0) && (header.numSlots == 0))
+		{	// новый файл: размер уже задан, ячейки заполнены нулями
+			std::memcpy(header.magic, CACHE_INDEX_MAGIC, sizeof(header.magic));
+			header.version = CACHE_INDEX_VERSION;
+			header.numSlots = numSlots;
+			header.numUsed = 0;
+		}
+		bool valid = (std::memcmp(header.magic, CACHE_INDEX_MAGIC, sizeof(header.magic)) == 0)
+			&& (header.version == CACHE_INDEX_VERSION) && (header.numSlots != 0)
+			&& ((header.numSlots & (header.numSlots - 1)) == 0)
+			&& (header.numSlots <= (index.size - sizeof(CacheIndexHeader)) / sizeof(CacheIndexSlot))
+			&& (header.numUsed <= header.numSlots);
+		if (!valid)
+		{
+			index.Close();
+			return false;
+		}
+		uint64_t used = 0;				// numUsed пересчитывается: после сбоя он мог отстать от ячеек
+		CacheIndexSlot* slots = Slots();
+		for (uint64_t i = 0; i < header.numSlots; ++i)
+		{
+			if ((slots[i].lo == 0) && (slots[i].hi == 0)) continue;
+			if (InBlobs(slots[i])) ++used;
+			else slots[i] = CacheIndexSlot();
+		}
+		header.numUsed = used;
+		return true;
+	}
+
+	bool InBlobs(CacheIndexSlot const& slot) const	// ответ ячейки целиком лежит в results.dat
+	{
+		return (slot.offset <= blobsSize) && (slot.length <= blobsSize - slot.offset);
+	}
+
+	CacheIndexSlot* Probe(CacheKey const& key)	// ячейка с ключом или первая пустая на его пути; nullptr -- все заняты
+	{
+		uint64_t mask = Header().numSlots - 1;
+		CacheIndexSlot* slots = Slots();
+		uint64_t i = key.lo & mask;
+		for (uint64_t step = 0; step <= mask; ++step, i = (i + 1) & mask)
+		{
+			if (((slots[i].lo == key.lo) && (slots[i].hi == key.hi)) || ((slots[i].lo == 0) && (slots[i].hi == 0)))
+			{
+				return &slots[i];
+			}
+		}
+		return nullptr;
+	}
+
+	bool FindOnDisk(CacheKey const& key, std::string& result)
+	{
+		if (!index.data) return false;
+		CacheIndexSlot* slot = Probe(key);
+		if (!slot || ((slot->lo == 0) && (slot->hi == 0)) || !InBlobs(*slot)) return false;
+		result.resize((size_t)slot->length);
+		if (!SeekBlob(blobs, slot->offset, SEEK_SET)) return false;
+		return std::fread(&result[0], 1, result.size(), blobs) == result.size();
+	}
+
+	void StoreOnDisk(CacheKey const& key, std::string const& result)
+	{
+		if (!index.data || result.empty()) return;
+		if (Header().numUsed * 4 >= Header().numSlots * 3)
+		{
+			if (growFailed || !Grow()) return;
+		}
+		CacheIndexSlot* slot = Probe(key);
+		if (!slot || (slot->lo != 0) || (slot->hi != 0)) return;
+
+		if (!SeekBlob(blobs, 0, SEEK_END)) return;
+		long long offset = TellBlob(blobs);
+		if ((offset < 0) || (std::fwrite(result.data(), 1, result.size(), blobs) != result.size())) return;
+		std::fflush(blobs);
+		blobsSize = (uint64_t)offset + result.size();
+		slot->offset = (uint64_t)offset;
+		slot->length = result.size();
+		slot->hi = key.hi;
+		slot->lo = key.lo;				// ключ -- последним: ячейка не видна, пока не заполнена
+		Header().numUsed++;
+	}
+
+	bool Grow()
+	{	// индекс вдвое больше собирается рядом и подменяет старый; false -- остался старый индекс
+		std::vector<CacheIndexSlot> old(Slots(), Slots() + Header().numSlots);
+		uint64_t numSlots = Header().numSlots * 2;
+		std::string fileName = dir + "index.dat";
+		std::string newName = dir + "index.new";
+		index.Close();
+		std::remove(newName.c_str());
+		bool built = (numSlots <= (SIZE_MAX - sizeof(CacheIndexHeader)) / sizeof(CacheIndexSlot))
+			&& OpenIndex(newName, numSlots);
+		if (built)
+		{
+			for (auto& slot : old)
+			{
+				if (((slot.lo == 0) && (slot.hi == 0)) || !InBlobs(slot)) continue;
+				CacheKey key;
+				key.lo = slot.lo;
+				key.hi = slot.hi;
+				CacheIndexSlot* target = Probe(key);
+				if (!target) continue;
+				*target = slot;
+				Header().numUsed++;
+			}
+			index.Close();
+#ifdef _WIN32
+			built = MoveFileExA(newName.c_str(), fileName.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+			built = std::rename(newName.c_str(), fileName.c_str()) == 0;
+#endif
+		}
+		if (built && OpenIndex(fileName, numSlots)) return true;
+
+		growFailed = true;
+		std::remove(newName.c_str());
+		if (!built && OpenIndex(fileName, old.size()))
+		{
+			Out() << "Cache: cannot grow " << fileName << ", new results are kept in memory only" << std::endl;
+		}
+		else
+		{
+			index.Close();
+			Out() << "Cache: cannot reopen " << fileName << ", disk cache disabled" << std::endl;
+		}
+		return false;
+	}
+
+	std::mutex lock;
+	size_t capacity = 1;
+	RecentList recent;
+	std::unordered_map<CacheKey, RecentList::iterator, CacheKeyHash> byKey;
+	std::string dir;
+	WritableMapping index;
+	std::FILE* blobs = nullptr;
+	uint64_t blobsSize = 0;			// длина results.dat
+	bool growFailed = false;		// индекс не перестроился: на диск больше не пишем
+	std::atomic<uint64_t> hits{ 0 };
+	std::atomic<uint64_t> diskHits{ 0 };
+	std::atomic<uint64_t> misses{ 0 };
+};
+
+static const size_t CACHE_DEFAULT_ENTRIES = 4096;
+
+inline bool ParseCacheOption(std::string const& arg, size_t& entries, std::string& dir)
+{	// --cache (в памяти CACHE_DEFAULT_ENTRIES ответов), --cache=N, --cache-dir=каталог (еще и на диске)
+	if (arg == "--cache") entries = CACHE_DEFAULT_ENTRIES;
+	else if (ParseCountOption(arg, "--cache=", entries)) {}
+	else if (arg.compare(0, 12, "--cache-dir=") == 0) dir = arg.substr(12);
+	else return false;
+	if ((entries == 0) && !dir.empty()) entries = CACHE_DEFAULT_ENTRIES;
+	return true;
+}
+
+inline std::string CacheStats(ResultCache const& cache)
+{
+	return std::to_string(cache.Hits()) + " hits, " + std::to_string(cache.DiskHits()) + " disk hits, "
+		+ std::to_string(cache.Misses()) + " misses";
+}
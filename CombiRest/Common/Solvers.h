@@ -0,0 +1,34 @@
+// Solvers.h: входы Combi18, Combi23 и Combi51 как библиотечных функций, только заголовок.
+// Если собрать Combi18.cpp, Combi23.cpp и Combi51.cpp с COMBI_LIBRARY, в них нет main, и их можно
+// скомпоновать в одну программу (CombiDaemon). Каждый решатель живет в своем пространстве имен.
+// Solve не печатает и не трогает общего состояния: один вызов -- один граф, scratch -- рабочая память
+// вызывающего потока (создается при первом вызове и переиспользуется). Ответ -- строка, как в пакетном
+// режиме; false -- граф не прочитан или опция не подходит, в answer тогда причина.
+// cache (может быть nullptr) -- общий для потоков кэш ответов (см. Common/ResultCache.h)
+
+#pragma once
+
+#include "GraphIo.h"
+#include "ResultCache.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Tour				// Combi18: гамильтонов цикл минимальной стоимости; опция --max-vertices=N -- граф
+{							// больше N вершин не решается (если опция повторена, действует наименьшее N)
+	bool Solve(GraphSource const& source, std::vector<std::string> const& options, ResultCache* cache,
+		std::shared_ptr<void>& scratch, std::string& answer);
+}
+
+namespace Planarity			// Combi23: проверка планарности гамма-алгоритмом
+{
+	bool Solve(GraphSource const& source, std::vector<std::string> const& options, ResultCache* cache,
+		std::shared_ptr<void>& scratch, std::string& answer);
+}
+
+namespace Matching			// Combi51: паросочетание в двудольном графе; опции -- как в командной строке Combi51
+{
+	bool Solve(GraphSource const& source, std::vector<std::string> const& options, ResultCache* cache,
+		std::shared_ptr<void>& scratch, std::string& answer);
+}
@@ -0,0 +1,93 @@
+// Bench18.cpp: бенчмарк Combi18 (перебор в задаче коммивояжера) на синтетических полных графах.
+// Семейства: euclidean -- точки на плоскости, стоимость -- расстояние; random -- случайные стоимости.
+// Этапы: parse -- LoadGraph из текста в памяти, search -- перебор. --engines: general -- FindMinHamiltonCycle,
+// bitmask -- FindMinHamiltonCycleSmall (графы до 64 вершин); по умолчанию оба, строка отчета -- семейство/перебор.
+// Перебор экспоненциальный, поэтому размеры растут, пока один прогон укладывается в --max-seconds; размер,
+// который по росту времени на прошлых размерах не уложится, пропускается (BenchBudget, см. BenchUtil.h).
+// Решатель включается исходным текстом (собранным с COMBI_LIBRARY), чтобы мерить его этапы по отдельности
+
+#include "Combi18/Combi18.cpp"
+#include "BenchUtil.h"
+#include "Generators.h"
+
+using namespace Tour;
+
+int main(int argc, char* argv[])
+{
+	BenchOptions opts;
+	if (!ParseBenchOptions(argc, argv, opts)) return 1;
+	std::vector<size_t> sizes = opts.sizes;
+	if (sizes.empty()) sizes = { 5, 6, 7, 8, 9, 10, 11, 12, 13, 14 };
+	std::vector<std::string> engines = opts.engines;
+	if (engines.empty()) engines = { "general", "bitmask" };
+	for (auto& engine : engines)
+	{
+		if ((engine != "general") && (engine != "bitmask"))
+		{
+			std::cerr << "Engine " << engine << " is not benchmarked: only general and bitmask\n";
+			return 1;
+		}
+	}
+
+	struct Family
+	{
+		std::string name;
+		std::function<GeneratedGraph(size_t, BenchRandom&)> make;
+	};
+	std::vector<Family> families = {
+		{ "euclidean", [](size_t n, BenchRandom& rng) { return EuclideanComplete(n, rng); } },
+		{ "random", [](size_t n, BenchRandom& rng) { return RandomComplete(n, rng); } },
+	};
+
+	std::vector<std::string> phases = { "parse", "search" };
+	BenchReport report(opts, "Combi18", phases);
+	BenchBudget budget(opts, GrowthExponential);
+	TourScratch scratch;
+	for (auto& family : families)
+	{
+		if (!FamilyWanted(opts, family.name)) continue;
+		BenchRandom rng(opts.seed);		// у каждого семейства своя последовательность: --families не меняет входов
+		std::vector<GeneratedGraph> generated;		// графы семейства строятся один раз для обоих переборов
+		for (auto& engine : engines)
+		{
+			std::string rowName = family.name + "/" + engine;
+			budget.Reset();
+			for (size_t k = 0; k < sizes.size(); ++k)
+			{
+				if (k == generated.size())
+				{
+					generated.push_back(family.make(sizes[k], rng));
+					WriteInstance(opts, family.name + "-" + std::to_string(sizes[k]), generated[k].text);
+				}
+				GeneratedGraph const& g = generated[k];
+				if (!budget.Allows(rowName, g.vertices, g.edges)) continue;
+				GraphSource source;
+				source.Attach(g.text.data(), g.text.data() + g.text.size());
+
+				PhaseTimer timer(phases);
+				std::string result;
+				for (int r = 0; r < opts.repeat; ++r)
+				{
+					size_t numEdges = 0;
+					timer.Time(0, [&]() { LoadGraph(source, scratch.graph, numEdges); });
+					timer.Time(1, [&]()
+					{
+						scratch.eVec.clear();
+						scratch.hCycle.clear();
+						int minCost = EdgeSetCost(scratch.graph.allEdges);
+						if ((engine == "general") || !FindMinHamiltonCycleSmall(scratch.graph, scratch.small, scratch.hCycle, minCost))
+						{
+							FindMinHamiltonCycle(scratch.graph, 0, scratch.eVec, scratch.hCycle, minCost);
+						}
+					});
+					result = scratch.hCycle.empty() ? "no cycle" : "cost " + std::to_string(EdgeSetCost(scratch.hCycle));
+					if (timer.Total() > opts.maxSeconds) break;	// дальше повторять слишком долго
+				}
+				report.Row(rowName, g.vertices, g.edges, timer, result);
+				budget.Record(g.vertices, g.edges, timer.Total());
+				if (timer.Total() > opts.maxSeconds) break;
+			}
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,92 @@
+// Bench23.cpp: бенчмарк Combi23 (гамма-алгоритм) на синтетических графах.
+// Семейства: triangulation -- случайные максимальные плоские графы (ответ -- planar), near-planar -- те же
+// триангуляции с одним лишним ребром (ответ -- nonplanar, противоречие находится в конце укладки).
+// Этапы: parse -- LoadGraph из текста в памяти, relabel -- перенумерация вершин (--relabel=none,bfs,rcm,degree,
+// см. Common/Relabel.h; каждый порядок -- своя строка семейство/порядок), gamma -- MakeFaces с переиспользуемыми
+// буферами. Окупается ли перенумерация -- relabel ms против выигрыша в gamma.
+// Решатель включается исходным текстом (собранным с COMBI_LIBRARY), чтобы мерить его этапы по отдельности
+
+#include "Combi23/Combi23.cpp"
+#include "BenchUtil.h"
+#include "Generators.h"
+
+using namespace Planarity;
+
+int main(int argc, char* argv[])
+{
+	BenchOptions opts;
+	if (!ParseBenchOptions(argc, argv, opts)) return 1;
+	std::vector<size_t> sizes = opts.sizes;
+	if (sizes.empty()) sizes = { 50, 100, 200, 400, 800, 1600, 3200, 6400, 12800 };
+	std::vector<RelabelKind> relabels;
+	for (auto& name : opts.relabels.empty() ? std::vector<std::string>{ "none" } : opts.relabels)
+	{
+		RelabelKind kind;
+		if (!ParseRelabel(name, kind))
+		{
+			std::cerr << "Unknown vertex order " << name << ": none, bfs, rcm or degree\n";
+			return 1;
+		}
+		relabels.push_back(kind);
+	}
+
+	struct Family
+	{
+		std::string name;
+		size_t extraEdges;
+	};
+	std::vector<Family> families = { { "triangulation", 0 }, { "near-planar", 1 } };
+
+	std::vector<std::string> phases = { "parse", "relabel", "gamma" };
+	BenchReport report(opts, "Combi23", phases);
+	BenchBudget budget(opts, GrowthPower);
+	PlanarityScratch scratch;
+	for (auto& family : families)
+	{
+		if (!FamilyWanted(opts, family.name)) continue;
+		BenchRandom rng(opts.seed);
+		std::vector<GeneratedGraph> generated;		// графы семейства строятся один раз для всех порядков
+		for (RelabelKind kind : relabels)
+		{
+			std::string rowName = family.name;
+			if (!opts.relabels.empty()) rowName += std::string("/") + RelabelName(kind);
+			budget.Reset();
+			for (size_t k = 0; k < sizes.size(); ++k)
+			{
+				if (k == generated.size())
+				{
+					generated.push_back(Triangulation(std::max<size_t>(sizes[k], 4), rng, family.extraEdges));
+					WriteInstance(opts, family.name + "-" + std::to_string(sizes[k]), generated[k].text);
+				}
+				GeneratedGraph const& g = generated[k];
+				if (!budget.Allows(rowName, g.vertices, g.edges)) continue;
+				GraphSource source;
+				source.Attach(g.text.data(), g.text.data() + g.text.size());
+
+				PhaseTimer timer(phases);
+				std::string result;
+				for (int r = 0; r < opts.repeat; ++r)
+				{
+					size_t numEdges = 0;
+					timer.Time(0, [&]() { LoadGraph(source, scratch.graph, numEdges); });
+					timer.Time(1, [&]()
+					{	// грани в номера файла не переводятся: число граней от номеров не зависит
+						if (kind != RelabelNone) RelabelGraph(scratch.graph, kind, scratch.relabel);
+					});
+					bool planar = false;
+					timer.Time(2, [&]()
+					{
+						scratch.faceSet.clear();
+						planar = MakeFaces(scratch.graph, scratch.faceSet, scratch.comps, scratch.faces);
+					});
+					result = planar ? "planar, " + std::to_string(scratch.faceSet.size()) + " faces" : "nonplanar";
+					if (timer.Total() > opts.maxSeconds) break;
+				}
+				report.Row(rowName, g.vertices, g.edges, timer, result);
+				budget.Record(g.vertices, g.edges, timer.Total());
+				if (timer.Total() > opts.maxSeconds) break;
+			}
+		}
+	}
+	return 0;
+}
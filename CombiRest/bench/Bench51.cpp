@@ -0,0 +1,128 @@
+// Bench51.cpp: бенчмарк Combi51 (максимальное паросочетание в двудольном графе) на синтетических графах.
+// Семейства: sparse -- n x n, у каждой вершины первой доли 4 случайных соседа (список ребер); dense -- n x n,
+// ребро с вероятностью 0.3 (матрица). Каждый граф решается каждым алгоритмом из --engines (по умолчанию
+// kuhn, hk, dense и parallel); строка отчета -- семейство/алгоритм. --sizes -- число вершин в каждой доле.
+// Этапы: parse -- LoadGraph из текста в памяти, relabel -- перенумерация вершин (--relabel=none,bfs,rcm,degree,
+// см. Common/Relabel.h; каждый порядок -- своя строка семейство/алгоритм/порядок, none -- без перестановки),
+// init -- порядок вершин и начальное паросочетание Карпа-Сипсера, augment -- поиск увеличивающих цепей
+// выбранным алгоритмом. Окупается ли перенумерация -- relabel ms против выигрыша в init и augment.
+// Решатель включается исходным текстом (собранным с COMBI_LIBRARY), чтобы мерить его этапы по отдельности
+
+#include "Combi51/Combi51.cpp"
+#include "BenchUtil.h"
+#include "Generators.h"
+
+using namespace Matching;
+
+int main(int argc, char* argv[])
+{
+	BenchOptions opts;
+	if (!ParseBenchOptions(argc, argv, opts)) return 1;
+	std::vector<std::string> engines = opts.engines;
+	if (engines.empty()) engines = { "kuhn", "hk", "dense", "parallel" };
+	for (auto& engine : engines)
+	{
+		if ((engine != "kuhn") && (engine != "hk") && (engine != "dense") && (engine != "parallel"))
+		{
+			std::cerr << "Engine " << engine << " is not benchmarked: only kuhn, hk, dense and parallel\n";
+			return 1;
+		}
+	}
+	std::vector<RelabelKind> relabels;
+	for (auto& name : opts.relabels.empty() ? std::vector<std::string>{ "none" } : opts.relabels)
+	{
+		RelabelKind kind;
+		if (!ParseRelabel(name, kind))
+		{
+			std::cerr << "Unknown vertex order " << name << ": none, bfs, rcm or degree\n";
+			return 1;
+		}
+		relabels.push_back(kind);
+	}
+	size_t threads = std::max(1u, std::thread::hardware_concurrency());
+
+	struct Family
+	{
+		std::string name;
+		std::vector<size_t> sizes;
+		std::function<GeneratedGraph(size_t, BenchRandom&)> make;
+	};
+	std::vector<Family> families = {
+		{ "sparse", { 1000, 4000, 16000, 64000, 256000 },
+			[](size_t n, BenchRandom& rng) { return SparseBipartite(n, 4, rng); } },
+		{ "dense", { 250, 500, 1000, 2000, 4000 },
+			[](size_t n, BenchRandom& rng) { return DenseBipartite(n, 0.3, rng); } },
+	};
+
+	std::vector<std::string> phases = { "parse", "relabel", "init", "augment" };
+	BenchReport report(opts, "Combi51", phases);
+	BenchBudget budget(opts, GrowthPower);
+	Graph graph;
+	std::vector<int> order;
+	RelabelScratch relabel;
+	for (auto& family : families)
+	{
+		if (!FamilyWanted(opts, family.name)) continue;
+		std::vector<size_t> sizes = opts.sizes.empty() ? family.sizes : opts.sizes;
+		BenchRandom rng(opts.seed);
+		std::vector<GeneratedGraph> generated;		// графы семейства строятся один раз для всех алгоритмов
+		for (auto& engine : engines)
+		{
+			Options engineOpts;
+			engineOpts.engine = engine;
+			for (RelabelKind kind : relabels)
+			{
+				std::string rowName = family.name + "/" + engine;
+				if (!opts.relabels.empty()) rowName += std::string("/") + RelabelName(kind);
+				budget.Reset();
+				for (size_t k = 0; k < sizes.size(); ++k)
+				{
+					if (k == generated.size())
+					{
+						generated.push_back(family.make(sizes[k], rng));
+						WriteInstance(opts, family.name + "-" + std::to_string(sizes[k]), generated[k].text);
+					}
+					GeneratedGraph const& g = generated[k];
+					if (!budget.Allows(rowName, g.vertices, g.edges)) continue;
+					GraphSource source;
+					source.Attach(g.text.data(), g.text.data() + g.text.size());
+
+					PhaseTimer timer(phases);
+					std::string result;
+					for (int r = 0; r < opts.repeat; ++r)
+					{
+						std::string problem;
+						timer.Time(0, [&]() { LoadGraph(source, graph, false, problem); });
+						timer.Time(1, [&]()
+						{	// ответ в номера файла не переводится: размер паросочетания от номеров не зависит
+							if (kind == RelabelNone) return;
+							BipartiteLocalityOrder(graph.csr, graph.part2num, kind, relabel.part1, relabel.part2);
+							PermuteCsr(graph.csr, relabel.part1.order, relabel.part2.newNumber, relabel.csr);
+							std::swap(graph.csr, relabel.csr);
+						});
+						timer.Time(2, [&]()
+						{
+							VertexOrder(graph, engineOpts.minDegOrder, order);
+							KarpSipserInit(graph, order);
+						});
+						timer.Time(3, [&]()
+						{
+							if (engine == "hk") HopcroftKarp4AlltheGraph(graph);
+							else if (engine == "dense") Dense4AlltheGraph(graph, order);
+							else if (engine == "parallel") Parallel4AlltheGraph(graph, order, threads);
+							else Kuhn4AlltheGraph(graph, order);
+						});
+						size_t pairs = 0;
+						for (size_t i = 1; i <= graph.part2num; ++i) pairs += (graph.matches[i] != -1);
+						result = std::to_string(pairs) + " pairs";
+						if (timer.Total() > opts.maxSeconds) break;
+					}
+					report.Row(rowName, g.vertices, g.edges, timer, result);
+					budget.Record(g.vertices, g.edges, timer.Total());
+					if (timer.Total() > opts.maxSeconds) break;
+				}
+			}
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,286 @@
+// BenchUtil.h: общее для бенчмарков Combi18, Combi23 и Combi51 (сборка -- CombiRest/CMakeLists.txt).
+// Генератор случайных чисел свой (splitmix64): std::uniform_int_distribution и std::shuffle в разных
+// стандартных библиотеках дают разные последовательности, а входы должны совпадать при одном --seed.
+// Каждая строка отчета -- семейство графов, размер, время этапов (лучшее из --repeat прогонов), общая
+// пропускная способность и наклон кривой масштабирования: log(t / t_пред) / log(m / m_пред) по числу ребер m.
+// Размер, который по прошлым прогонам строки (BenchBudget) займет больше --max-seconds, пропускается
+// с сообщением в stderr. В заголовке отчета (в CSV -- столбец build) -- ключи сборки, от которых зависит
+// время: avx2 (-DCOMBI_AVX2=ON или -march с AVX2 -- битовые ядра Combi51 на AVX2) и mem-stats
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+class BenchRandom
+{
+public:
+	explicit BenchRandom(uint64_t seed) : state(seed) {}
+
+	uint64_t Next()
+	{
+		uint64_t x = (state += 0x9e3779b97f4a7c15ULL);
+		x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+		return x ^ (x >> 31);
+	}
+
+	uint64_t Below(uint64_t bound)		// равномерно в [0, bound)
+	{
+		uint64_t limit = ~0ULL - (~0ULL % bound);
+		uint64_t x;
+		do x = Next(); while (x >= limit);
+		return x % bound;
+	}
+
+	double Unit() { return (Next() >> 11) * (1.0 / 9007199254740992.0); }	// [0, 1)
+
+private:
+	uint64_t state;
+};
+
+template <typename T>
+void Shuffle(std::vector<T>& items, BenchRandom& rng)
+{
+	for (size_t i = items.size(); i > 1; --i) std::swap(items[i - 1], items[(size_t)rng.Below(i)]);
+}
+
+struct BenchOptions
+{
+	uint64_t seed = 1;
+	int repeat = 3;
+	double maxSeconds = 2.0;			// размеры растут, пока один прогон укладывается (и по прогнозу уложится) в это время
+	std::vector<size_t> sizes;			// пусто -- размеры по умолчанию у каждого бенчмарка
+	std::vector<std::string> families;	// пусто -- все семейства
+	std::vector<std::string> engines;	// Bench18 и Bench51
+	std::vector<std::string> relabels;	// Bench23 и Bench51: порядки вершин (см. Common/Relabel.h), пусто -- без перестановки
+	std::string writeDir;				// куда сохранить сгенерированные входы
+	bool csv = false;
+};
+
+inline std::vector<std::string> SplitList(std::string const& text)
+{
+	std::vector<std::string> items;
+	size_t begin = 0;
+	while (begin <= text.size())
+	{
+		size_t end = std::min(text.find(',', begin), text.size());
+		if (end > begin) items.push_back(text.substr(begin, end - begin));
+		begin = end + 1;
+	}
+	return items;
+}
+
+inline bool ParseBenchOptions(int argc, char* argv[], BenchOptions& opts)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg(argv[i]);
+		if (arg.compare(0, 7, "--seed=") == 0) opts.seed = std::stoull(arg.substr(7));
+		else if (arg.compare(0, 9, "--repeat=") == 0) opts.repeat = std::max(1, std::stoi(arg.substr(9)));
+		else if (arg.compare(0, 14, "--max-seconds=") == 0) opts.maxSeconds = std::stod(arg.substr(14));
+		else if (arg.compare(0, 8, "--sizes=") == 0)
+		{
+			for (auto& size : SplitList(arg.substr(8))) opts.sizes.push_back(std::stoul(size));
+		}
+		else if (arg.compare(0, 11, "--families=") == 0) opts.families = SplitList(arg.substr(11));
+		else if (arg.compare(0, 10, "--engines=") == 0) opts.engines = SplitList(arg.substr(10));
+		else if (arg.compare(0, 10, "--relabel=") == 0) opts.relabels = SplitList(arg.substr(10));
+		else if (arg.compare(0, 8, "--write=") == 0) opts.writeDir = arg.substr(8);
+		else if (arg == "--csv") opts.csv = true;
+		else
+		{
+			std::cerr << "Unknown option " << arg << "\n"
+				<< "Options: --seed=S --repeat=R --max-seconds=T --sizes=a,b,... --families=f,... "
+				<< "--engines=e,... --relabel=r,... --write=dir --csv\n";
+			return false;
+		}
+	}
+	return true;
+}
+
+inline bool FamilyWanted(BenchOptions const& opts, std::string const& family)
+{
+	return opts.families.empty() || (std::find(opts.families.begin(), opts.families.end(), family) != opts.families.end());
+}
+
+inline void WriteInstance(BenchOptions const& opts, std::string const& name, std::string const& text)
+{	// вход можно потом дать самой программе: Combi23 каталог/triangulation-1000.txt
+	if (opts.writeDir.empty()) return;
+	std::ofstream out(opts.writeDir + "/" + name + ".txt", std::ios::binary);
+	out << text;
+}
+
+inline std::string BuildFlags()
+{
+	std::string flags;
+#ifdef __AVX2__
+	flags = "avx2";
+#else
+	flags = "no-avx2";
+#endif
+#ifdef COMBI_MEM_STATS
+	flags += "+mem-stats";
+#endif
+	return flags;
+}
+
+enum BenchGrowth
+{
+	GrowthPower,					// t ~ m^k по числу ребер: полиномиальные алгоритмы
+	GrowthExponential				// t ~ g^n по числу вершин: перебор
+};
+
+class BenchBudget					// прогноз времени прогона по прошлым размерам той же строки отчета
+{
+public:
+	BenchBudget(BenchOptions const& options, BenchGrowth growthModel) : opts(options), growth(growthModel) {}
+
+	void Reset()					// новая строка: семейство, алгоритм, порядок
+	{
+		measured = 0;
+		steepest = 0;
+	}
+
+	bool Allows(std::string const& row, size_t vertices, size_t edges) const
+	{	// false -- прогон по прогнозу дольше --max-seconds; об этом -- строка в stderr
+		if (measured == 0) return true;
+		double x = Scale(vertices, edges);
+		if (x <= lastScale) return true;
+		double predicted = (growth == GrowthPower)
+			? lastSeconds * std::pow(x / lastScale, Steepness(2.0))
+			: lastSeconds * std::pow(Steepness(lastScale + 1), x - lastScale);
+		if (predicted <= opts.maxSeconds) return true;
+		std::cerr << row << " " << vertices << ": skipped, predicted " << predicted << " s > --max-seconds\n";
+		return false;
+	}
+
+	void Record(size_t vertices, size_t edges, double seconds)
+	{
+		double x = Scale(vertices, edges);
+		if ((measured > 0) && (x > lastScale) && (lastSeconds >= minSeconds) && (seconds >= minSeconds))
+		{	// самый крутой рост строки: по одному шагу рост недооценивается из-за разброса (у перебора -- в разы)
+			double step = (growth == GrowthPower)
+				? std::log(seconds / lastSeconds) / std::log(x / lastScale)
+				: std::pow(seconds / lastSeconds, 1.0 / (x - lastScale));
+			steepest = std::max(steepest, step);
+		}
+		measured++;
+		lastScale = x;
+		lastSeconds = seconds;
+	}
+
+private:
+	static constexpr double minSeconds = 1e-4;	// короче -- время в основном шум
+
+	double Scale(size_t vertices, size_t edges) const { return (growth == GrowthPower) ? (double)edges : (double)vertices; }
+
+	double Steepness(double prior) const
+	{	// пока роста не видно -- prior: квадрат для полиномов, n! (множитель n + 1 на вершину) для перебора
+		return std::max(1.0, (steepest > 0) ? steepest : prior);
+	}
+
+	BenchOptions const& opts;
+	BenchGrowth growth;
+	size_t measured = 0;
+	double lastScale = 0;
+	double lastSeconds = 0;
+	double steepest = 0;
+};
+
+class PhaseTimer					// лучшее время каждого этапа по всем повторам
+{
+public:
+	explicit PhaseTimer(std::vector<std::string> const& phaseNames) : names(phaseNames), best(phaseNames.size(), 1e300) {}
+
+	template <typename F>
+	void Time(size_t phase, F body)
+	{
+		auto start = std::chrono::steady_clock::now();
+		body();
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		best[phase] = std::min(best[phase], seconds);
+	}
+
+	double Seconds(size_t phase) const { return best[phase]; }
+	double Total() const
+	{
+		double total = 0;
+		for (double t : best) total += t;
+		return total;
+	}
+	std::vector<std::string> const& Names() const { return names; }
+
+private:
+	std::vector<std::string> names;
+	std::vector<double> best;
+};
+
+class BenchReport					// таблица или CSV; наклон считается внутри одного семейства
+{
+public:
+	BenchReport(BenchOptions const& options, std::string const& benchName, std::vector<std::string> const& phaseNames)
+		: opts(options), phases(phaseNames)
+	{
+		if (opts.csv)
+		{
+			std::cout << "bench,build,family,vertices,edges";
+			for (auto& phase : phases) std::cout << "," << phase << "_ms";
+			std::cout << ",total_ms,medges_per_s,slope,result\n";
+		}
+		else
+		{
+			std::cout << benchName << ", seed " << opts.seed << ", best of " << opts.repeat << ", build " << BuildFlags() << "\n";
+			std::printf("%-22s %9s %10s", "family", "vertices", "edges");
+			for (auto& phase : phases) std::printf(" %11s", (phase + " ms").c_str());
+			std::printf(" %11s %9s %6s  %s\n", "total ms", "Medge/s", "slope", "result");
+		}
+		name = benchName;
+	}
+
+	void Row(std::string const& family, size_t vertices, size_t edges, PhaseTimer const& timer, std::string const& result)
+	{
+		double total = timer.Total();
+		double slope = 0;
+		bool haveSlope = (family == lastFamily) && (lastEdges > 0) && (edges > lastEdges) && (lastTotal > 0) && (total > 0);
+		if (haveSlope) slope = std::log(total / lastTotal) / std::log((double)edges / lastEdges);
+		double rate = (total > 0) ? edges / total / 1e6 : 0;
+		if (opts.csv)
+		{
+			std::cout << name << "," << BuildFlags() << "," << family << "," << vertices << "," << edges;
+			for (size_t i = 0; i < phases.size(); ++i) std::cout << "," << timer.Seconds(i) * 1e3;
+			std::cout << "," << total * 1e3 << "," << rate << ",";
+			if (haveSlope) std::cout << slope;
+			std::cout << "," << result << "\n";
+		}
+		else
+		{
+			std::printf("%-22s %9zu %10zu", family.c_str(), vertices, edges);
+			for (size_t i = 0; i < phases.size(); ++i) std::printf(" %11.3f", timer.Seconds(i) * 1e3);
+			std::printf(" %11.3f %9.2f ", total * 1e3, rate);
+			if (haveSlope) std::printf("%6.2f", slope);
+			else std::printf("%6s", "-");
+			std::printf("  %s\n", result.c_str());
+		}
+		std::cout.flush();
+		lastFamily = family;
+		lastEdges = edges;
+		lastTotal = total;
+	}
+
+private:
+	BenchOptions const& opts;
+	std::vector<std::string> phases;
+	std::string name;
+	std::string lastFamily;
+	size_t lastEdges = 0;
+	double lastTotal = 0;
+};
@@ -0,0 +1,217 @@
+// Generators.h: синтетические входы бенчмарков в текстовых форматах Combi18, Combi23 и Combi51.
+// Вершины нумеруются с 1. Результат зависит только от параметров и состояния BenchRandom
+
+#pragma once
+
+#include "BenchUtil.h"
+
+#include <array>
+#include <map>
+#include <set>
+#include <sstream>
+#include <utility>
+
+struct GeneratedGraph
+{
+	std::string text;			// вход программы
+	size_t vertices = 0;
+	size_t edges = 0;
+};
+
+// Combi18. Полный граф на n точках с целыми координатами в квадрате side x side; стоимость ребра --
+// округленное евклидово расстояние (не меньше 1). Ребра перемешаны: порядок ребер во входе -- порядок перебора
+inline GeneratedGraph EuclideanComplete(size_t n, BenchRandom& rng, int side = 1000)
+{
+	std::vector<std::pair<int, int>> points(n + 1);
+	for (size_t i = 1; i <= n; ++i) points[i] = std::make_pair((int)rng.Below(side), (int)rng.Below(side));
+	std::vector<std::pair<size_t, size_t>> pairs;
+	for (size_t i = 1; i <= n; ++i)
+	{
+		for (size_t j = i + 1; j <= n; ++j) pairs.push_back(std::make_pair(i, j));
+	}
+	Shuffle(pairs, rng);
+
+	GeneratedGraph g;
+	g.vertices = n;
+	g.edges = pairs.size();
+	std::ostringstream out;
+	out << n << " " << pairs.size() << "\n";
+	for (auto& p : pairs)
+	{
+		double dx = points[p.first].first - points[p.second].first;
+		double dy = points[p.first].second - points[p.second].second;
+		int weight = std::max(1, (int)std::lround(std::sqrt(dx * dx + dy * dy)));
+		out << p.first << " " << p.second << " " << weight << "\n";
+	}
+	g.text = out.str();
+	return g;
+}
+
+// Combi18. Полный граф со случайными стоимостями ребер 1..maxWeight (неравенство треугольника не выполняется)
+inline GeneratedGraph RandomComplete(size_t n, BenchRandom& rng, int maxWeight = 100)
+{
+	GeneratedGraph g;
+	g.vertices = n;
+	std::ostringstream out;
+	out << n << " " << n * (n - 1) / 2 << "\n";
+	for (size_t i = 1; i <= n; ++i)
+	{
+		for (size_t j = i + 1; j <= n; ++j) out << i << " " << j << " " << 1 + rng.Below(maxWeight) << "\n";
+	}
+	g.edges = n * (n - 1) / 2;
+	g.text = out.str();
+	return g;
+}
+
+// Combi23. Максимальный плоский граф (триангуляция) на n >= 4 вершинах: вершины по одной вставляются в
+// случайную треугольную грань, потом n случайных флипов ребер размывают степени (без флипов получается
+// стековая триангуляция с вершинами огромной степени). Номера вершин и порядок ребер перемешаны.
+// extraEdges > 0 -- после этого добавляются ребра между несмежными вершинами: у триангуляции любое
+// новое ребро делает граф неплоским, так что это почти плоские графы, на которых гамма-алгоритм
+// доходит почти до конца укладки и только там находит противоречие
+inline GeneratedGraph Triangulation(size_t n, BenchRandom& rng, size_t extraEdges = 0)
+{
+	typedef std::pair<int, int> EdgeKey;
+	auto key = [](int a, int b) { return EdgeKey(std::min(a, b), std::max(a, b)); };
+
+	std::vector<std::array<int, 3>> faces;
+	std::map<EdgeKey, std::array<int, 2>> edgeFaces;	// ребро -- две его грани
+	auto attach = [&](int face)
+	{
+		auto& f = faces[face];
+		for (int k = 0; k < 3; ++k)
+		{
+			auto& pair = edgeFaces.insert(std::make_pair(key(f[k], f[(k + 1) % 3]), std::array<int, 2>{ { -1, -1 } })).first->second;
+			pair[(pair[0] == -1) ? 0 : 1] = face;
+		}
+	};
+	auto replace = [&](EdgeKey e, int from, int to)
+	{
+		auto& pair = edgeFaces[e];
+		pair[(pair[0] == from) ? 0 : 1] = to;
+	};
+
+	// тетраэдр: 4 грани, у каждого ребра -- две
+	faces.push_back({ { 1, 2, 3 } });
+	faces.push_back({ { 1, 2, 4 } });
+	faces.push_back({ { 1, 3, 4 } });
+	faces.push_back({ { 2, 3, 4 } });
+	for (int f = 0; f < 4; ++f) attach(f);
+
+	for (int v = 5; v <= (int)n; ++v)
+	{	// вершина в грань (a, b, c): грань становится (a, b, v), добавляются (b, c, v) и (a, c, v)
+		int face = (int)rng.Below(faces.size());
+		std::array<int, 3> old = faces[face];
+		int a = old[0], b = old[1], c = old[2];
+		faces[face] = { { a, b, v } };
+		faces.push_back({ { b, c, v } });
+		faces.push_back({ { a, c, v } });
+		int f2 = (int)faces.size() - 2;
+		int f3 = (int)faces.size() - 1;
+		replace(key(b, c), face, f2);
+		replace(key(a, c), face, f3);
+		edgeFaces[key(a, v)] = { { face, f3 } };
+		edgeFaces[key(b, v)] = { { face, f2 } };
+		edgeFaces[key(c, v)] = { { f2, f3 } };
+	}
+
+	std::vector<EdgeKey> edgeList;
+	for (auto& e : edgeFaces) edgeList.push_back(e.first);
+	for (size_t flip = 0; flip < n; ++flip)
+	{	// ребро (a, b) между гранями (a, b, c) и (a, b, d) заменяем на (c, d), если его еще нет
+		size_t index = (size_t)rng.Below(edgeList.size());
+		EdgeKey ab = edgeList[index];
+		auto found = edgeFaces.find(ab);
+		int f1 = found->second[0];
+		int f2 = found->second[1];
+		int a = ab.first, b = ab.second;
+		auto third = [&](int face)
+		{
+			for (int x : faces[face]) if ((x != a) && (x != b)) return x;
+			return -1;
+		};
+		int c = third(f1);
+		int d = third(f2);
+		if ((c == d) || edgeFaces.count(key(c, d))) continue;
+		edgeFaces.erase(found);
+		faces[f1] = { { a, c, d } };
+		faces[f2] = { { b, c, d } };
+		replace(key(b, c), f1, f2);
+		replace(key(a, d), f2, f1);
+		edgeFaces[key(c, d)] = { { f1, f2 } };
+		edgeList[index] = key(c, d);
+	}
+
+	std::set<EdgeKey> present(edgeList.begin(), edgeList.end());
+	size_t maxEdges = n * (n - 1) / 2;
+	for (size_t added = 0; (added < extraEdges) && (present.size() < maxEdges); )
+	{
+		int u = 1 + (int)rng.Below(n);
+		int w = 1 + (int)rng.Below(n);
+		if ((u == w) || !present.insert(key(u, w)).second) continue;
+		edgeList.push_back(key(u, w));
+		++added;
+	}
+
+	std::vector<int> label(n + 1);
+	for (size_t i = 0; i <= n; ++i) label[i] = (int)i;
+	std::vector<int> tail(label.begin() + 1, label.end());
+	Shuffle(tail, rng);
+	std::copy(tail.begin(), tail.end(), label.begin() + 1);
+	Shuffle(edgeList, rng);
+
+	GeneratedGraph g;
+	g.vertices = n;
+	g.edges = edgeList.size();
+	std::ostringstream out;
+	out << n << " " << edgeList.size() << "\n";
+	for (auto& e : edgeList) out << label[e.first] << " " << label[e.second] << "\n";
+	g.text = out.str();
+	return g;
+}
+
+// Combi51. Разреженный двудольный граф n x n, список ребер: у каждой вершины первой доли ровно degree
+// различных соседей, выбранных равномерно
+inline GeneratedGraph SparseBipartite(size_t n, size_t degree, BenchRandom& rng)
+{
+	degree = std::min(degree, n);
+	GeneratedGraph g;
+	g.vertices = 2 * n;
+	g.edges = n * degree;
+	std::ostringstream out;
+	out << n << " " << n << " " << g.edges << "\n";
+	std::vector<size_t> neighbours;
+	for (size_t i = 1; i <= n; ++i)
+	{
+		neighbours.clear();
+		while (neighbours.size() < degree)
+		{
+			size_t j = 1 + (size_t)rng.Below(n);
+			if (std::find(neighbours.begin(), neighbours.end(), j) == neighbours.end()) neighbours.push_back(j);
+		}
+		for (size_t j : neighbours) out << i << " " << j << "\n";
+	}
+	g.text = out.str();
+	return g;
+}
+
+// Combi51. Плотный двудольный граф n x n в матричном формате: каждое ребро есть с вероятностью density
+inline GeneratedGraph DenseBipartite(size_t n, double density, BenchRandom& rng)
+{
+	GeneratedGraph g;
+	g.vertices = 2 * n;
+	std::string text = std::to_string(n) + " " + std::to_string(n) + "\n";
+	text.reserve(text.size() + n * 2 * n);
+	for (size_t i = 0; i < n; ++i)
+	{
+		for (size_t j = 0; j < n; ++j)
+		{
+			bool edge = rng.Unit() < density;
+			g.edges += edge;
+			text += edge ? '1' : '0';
+			text += (j + 1 < n) ? ' ' : '\n';
+		}
+	}
+	g.text = text;
+	return g;
+}
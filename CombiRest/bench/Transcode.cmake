@@ -0,0 +1,16 @@
+# Transcode.cmake: cmake -DIN=файл -DOUT=файл -P Transcode.cmake
+# Исходники проекта хранятся в UTF-16LE с BOM и CRLF (так их пишет Visual Studio); GCC и Clang их не читают.
+# Файл с BOM FF FE перекодируется в UTF-8 без CR, остальные копируются как есть
+
+file(READ "${IN}" bom LIMIT 2 HEX)
+if(bom STREQUAL "fffe")
+	execute_process(COMMAND iconv -f UTF-16 -t UTF-8 "${IN}"
+		OUTPUT_VARIABLE text RESULT_VARIABLE failed)
+	if(failed)
+		message(FATAL_ERROR "iconv cannot transcode ${IN}")
+	endif()
+	string(REPLACE "\r" "" text "${text}")
+	file(WRITE "${OUT}" "${text}")
+else()
+	configure_file("${IN}" "${OUT}" COPYONLY)
+endif()